@@ -15,6 +15,7 @@
 #include <plat/common/platform.h>
 
 #include <baikal_bl1_stack.h>
+#include <baikal_boot_timeline.h>
 #include <baikal_bootflash.h>
 #include <baikal_console.h>
 #include <baikal_io_storage.h>
@@ -59,6 +60,9 @@ int bl1_plat_handle_post_image_load(unsigned int image_id)
 		return 0;
 	}
 
+	baikal_boot_ts(BAIKAL_TS_BL2_LOADED);
+	plat_baikal_io_exit();
+
 	/* Get the image descriptor */
 	image_desc = bl1_plat_get_image_desc(BL2_IMAGE_ID);
 	assert(image_desc != NULL);
@@ -132,6 +136,7 @@ void bl1_early_platform_setup(void)
 {
 	int err;
 
+	baikal_boot_ts(BAIKAL_TS_BL1_START);
 	baikal_console_boot_init();
 
 	assert(trusted_mailbox == (void *)BAIKAL_TRUSTED_MAILBOX_BASE);
@@ -156,6 +161,9 @@ void bl1_early_platform_setup(void)
 		plat_panic_handler();
 	}
 
+	baikal_boot_ts_handover();
+	baikal_boot_ts(BAIKAL_TS_MEMTEST_END);
+
 	/*
 	 * Initialize Interconnect for this cluster during cold boot.
 	 * No need for locks as no other CPU is active.
@@ -195,9 +203,11 @@ void bl1_platform_setup(void)
 	generic_delay_timer_init();
 	mmavlsp_init();
 #if !DEBUG
+	baikal_boot_ts(BAIKAL_TS_BL1_SPLASH_START);
 	snprintf(msg_buf, sizeof(msg_buf), "BE-M1000\nBL1: %s\nBL1: %s\n", version_string, build_message);
 	lvds_early_splash(msg_buf);
 	mmxgbe_init();
 	hdmi_early_splash(msg_buf);
+	baikal_boot_ts(BAIKAL_TS_BL1_SPLASH_END);
 #endif
 }
@@ -11,6 +11,7 @@
 #include <common/bl_common.h>
 #include <common/debug.h>
 #include <common/desc_image_load.h>
+#include <drivers/generic_delay_timer.h>
 #include <lib/mmio.h>
 #include <lib/utils.h>
 #include <libfdt.h>
@@ -18,6 +19,7 @@
 #include <optee_utils.h>
 #endif
 
+#include <baikal_boot_timeline.h>
 #include <baikal_console.h>
 #include <baikal_def.h>
 #include <baikal_fdt.h>
@@ -49,10 +51,14 @@ void bl2_early_platform_setup2(u_register_t arg0,
 {
 	meminfo_t *mem_layout = (meminfo_t *)arg1;
 
+	baikal_boot_ts(BAIKAL_TS_BL2_START);
 	baikal_console_boot_init();
 
 	/* Setup the BL2 memory layout */
 	bl2_tzram_layout = *mem_layout;
+
+	/* The boot device drivers are used to load images from the FIP */
+	generic_delay_timer_init();
 	plat_baikal_io_setup();
 }
 
@@ -170,6 +176,7 @@ int bl2_plat_handle_post_image_load(unsigned int image_id)
 #endif
 	assert(bl_mem_params);
 
+	baikal_boot_ts_image_loaded(image_id);
 	switch (image_id) {
 #ifdef __aarch64__
 	case BL32_IMAGE_ID:
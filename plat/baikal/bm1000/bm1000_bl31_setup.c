@@ -9,6 +9,7 @@
 #include <plat/arm/common/plat_arm.h>
 #include <plat/common/platform.h>
 
+#include <baikal_boot_timeline.h>
 #include <baikal_gicv3.h>
 #include <bm1000_cmu.h>
 #include <bm1000_def.h>
@@ -102,7 +103,9 @@ void bl31_platform_setup(void)
 	cmu_clkch_enable_by_base(MMMALI_PVT_CLKCHCTL, PVT_CLKCH_DIV);
 
 	INFO("Init PCIe...\n");
+	baikal_boot_ts(BAIKAL_TS_PCIE_INIT_START);
 	mmpcie_init();
+	baikal_boot_ts(BAIKAL_TS_PCIE_INIT_END);
 
 	INFO("Init VDec...\n");
 	mmvdec_init();
@@ -113,7 +116,12 @@ void bl31_platform_setup(void)
 	baikal_gic_driver_init();
 	baikal_gic_init();
 
+	baikal_boot_ts(BAIKAL_TS_BL31_SPLASH_START);
 	bl31_splash();
+	baikal_boot_ts(BAIKAL_TS_BL31_SPLASH_END);
+
+	baikal_boot_ts(BAIKAL_TS_BL31_PLATFORM_SETUP_END);
+	baikal_boot_ts_print();
 }
 
 void bl31_plat_enable_mmu(uint32_t flags)
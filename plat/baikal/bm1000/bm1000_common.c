@@ -90,9 +90,11 @@ void baikal_configure_mmu_bl1(unsigned long total_base,
 
 #ifdef IMAGE_BL2
 static const mmap_region_t plat_baikal_mmap[] = {
+	MAP_MAILBOX_IRB,
 	MAP_NS_DRAM0,
 	MAP_NS_DRAM1,
 	MAP_SEC_DRAM,
+	MAP_SHARED_RAM,
 	MAP_DEVICE0,
 	MAP_DEVICE1,
 	{0}
@@ -761,6 +761,29 @@ int bmp_get_cpp(const uint8_t *bmp_file)
 	}
 }
 
+/*
+ * Expand 24-bpp pixels (blue, green, red byte order) to 32-bpp.
+ * Four pixels are taken at once as three words.
+ */
+static void bgr24_to_fb32(uint32_t *dst, const uint8_t *src, int n)
+{
+	uint32_t w0, w1, w2;
+
+	for (; n >= 4; n -= 4, src += 12, dst += 4) {
+		memcpy(&w0, src, sizeof(w0));
+		memcpy(&w1, src + 4, sizeof(w1));
+		memcpy(&w2, src + 8, sizeof(w2));
+		dst[0] = w0 & 0xffffff;
+		dst[1] = (w0 >> 24) | ((w1 & 0xffff) << 8);
+		dst[2] = (w1 >> 16) | ((w2 & 0xff) << 16);
+		dst[3] = w2 >> 8;
+	}
+
+	for (; n > 0; n--, src += 3) {
+		*dst++ = src[0] | (src[1] << 8) | (src[2] << 16);
+	}
+}
+
 int bmp_to_fb(uintptr_t fb, const modeline_t *mode, const uint8_t *bmp_file, int dx, int dy, int clear_screen)
 {
 	bmp_header_t bmp;
@@ -775,8 +798,8 @@ int bmp_to_fb(uintptr_t fb, const modeline_t *mode, const uint8_t *bmp_file, int
 	int data_size;
 	const uint8_t *last_line;
 	const uint8_t *first_line;
-	const uint8_t *src, *s;
-	uint8_t *dst, *d;
+	const uint8_t *src;
+	uint8_t *dst;
 
 	memcpy(&bmp, bmp_file + 2, sizeof(bmp)); /* skip 2-byte BMP signature */
 	line_width = bmp.width * bmp.bpp / 8;
@@ -827,9 +850,7 @@ int bmp_to_fb(uintptr_t fb, const modeline_t *mode, const uint8_t *bmp_file, int
 	dst = (void *)fb + y_offs * fb_line_width + x_offs * fb_cpp;
 	for (src = first_line; src >= last_line; src -= line_width) {
 		if (fb_cpp == 4 && bmp.bpp == 24) { /* convert 3-byte BMP to 4-byte FB */
-			for (s = src, d = dst; s < src + line_width; s += 3, d += 4) {
-				memcpy(d, s, 3);
-			}
+			bgr24_to_fb32((uint32_t *)dst, src, bmp.width);
 		} else {
 			memcpy(dst, src, line_width);
 		}
@@ -841,49 +862,189 @@ int bmp_to_fb(uintptr_t fb, const modeline_t *mode, const uint8_t *bmp_file, int
 	return fb_cpp;
 }
 
+int rle_logo_get_dimensions(const uint8_t *logo, int *width, int *height)
+{
+	rle_logo_header_t hdr;
+
+	memcpy(&hdr, logo, sizeof(hdr));
+	if (hdr.magic != RLE_LOGO_MAGIC) {
+		return -1;
+	}
+
+	*width = hdr.width;
+	*height = hdr.height;
+	return 0;
+}
+
+/* Decode an RLE logo straight into a 32-bpp framebuffer */
+int rle_logo_to_fb(uintptr_t fb, const modeline_t *mode, const uint8_t *logo, int dx, int dy, int clear_screen)
+{
+	rle_logo_header_t hdr;
+	const int fb_line_width = mode->hact * 4;
+	const int fb_size = fb_line_width * mode->vact;
+	const uint8_t *src = logo + sizeof(hdr);
+	const uint8_t *end;
+	uint8_t *line;
+	int y;
+
+	memcpy(&hdr, logo, sizeof(hdr));
+	if (hdr.magic != RLE_LOGO_MAGIC) {
+		return 0;
+	}
+
+	if (hdr.width > mode->hact || hdr.height > mode->vact) {
+		ERROR("Logo %ux%u exceeds maximum (%dx%d)\n",
+		      hdr.width, hdr.height, mode->hact, mode->vact);
+		return 0;
+	}
+
+	if (clear_screen) {
+		zero_normalmem((void *)fb, fb_size);
+	}
+
+	end = src + hdr.data_size;
+	line = (void *)fb + ((mode->vact - hdr.height) / 2 + dy) * fb_line_width +
+	       ((mode->hact - hdr.width) / 2 + dx) * 4;
+	for (y = 0; y < hdr.height; y++, line += fb_line_width) {
+		uint32_t *dst = (uint32_t *)line;
+		int x = 0;
+
+		while (x < hdr.width) {
+			const int n = (*src & RLE_LOGO_COUNT_MASK) + 1;
+			const int repeat = *src & RLE_LOGO_REPEAT;
+			const int size = 1 + (repeat ? 3 : n * 3);
+
+			if (src + size > end || x + n > hdr.width) {
+				ERROR("Logo is corrupt\n");
+				flush_dcache_range(fb, fb_size);
+				return 0;
+			}
+
+			if (repeat) {
+				const uint32_t color = src[1] | (src[2] << 8) | (src[3] << 16);
+
+				for (int i = 0; i < n; i++) {
+					dst[i] = color;
+				}
+			} else {
+				bgr24_to_fb32(dst, src + 1, n);
+			}
+
+			src += size;
+			dst += n;
+			x += n;
+		}
+	}
+
+	flush_dcache_range(fb, fb_size);
+	return 4;
+}
+
+#ifndef ARMTF_NO_PRINT
+/* Glyph rows are rendered as two 4-pixel nibbles */
+CASSERT(FONT_WIDTH == 8, assert_font_width);
+
+#define FB_NIBBLE(n, on)	{ (n) & 8 ? (on) : 0, (n) & 4 ? (on) : 0, \
+				  (n) & 2 ? (on) : 0, (n) & 1 ? (on) : 0 }
+#define FB_NIBBLES(on)		{ FB_NIBBLE(0x0, on), FB_NIBBLE(0x1, on), \
+				  FB_NIBBLE(0x2, on), FB_NIBBLE(0x3, on), \
+				  FB_NIBBLE(0x4, on), FB_NIBBLE(0x5, on), \
+				  FB_NIBBLE(0x6, on), FB_NIBBLE(0x7, on), \
+				  FB_NIBBLE(0x8, on), FB_NIBBLE(0x9, on), \
+				  FB_NIBBLE(0xa, on), FB_NIBBLE(0xb, on), \
+				  FB_NIBBLE(0xc, on), FB_NIBBLE(0xd, on), \
+				  FB_NIBBLE(0xe, on), FB_NIBBLE(0xf, on) }
+
+/* Pixels of a glyph row nibble, the leftmost pixel first */
+static const uint16_t fb_nibble16[16][4] = FB_NIBBLES(0xffff);
+static const uint32_t fb_nibble32[16][4] = FB_NIBBLES(0xffffffff);
+
+static int fb_is_printable(int ch)
+{
+	return ch >= FONT_FIRST_CHAR && ch <= FONT_LAST_CHAR;
+}
+
+/*
+ * Render 'n' printable characters out of 's[0..len)' one scanline at
+ * a time and flush the area they cover.
+ */
+static void fb_print_glyphs(uint8_t *pix, int line_width, int fb_cpp,
+			    const char *s, int len, int n)
+{
+	const int width = n * FONT_WIDTH * fb_cpp;
+	int i, k;
+
+	if (!n) {
+		return;
+	}
+
+	for (i = 0; i < FONT_HEIGHT; i++, pix += line_width) {
+		uint8_t *d = pix;
+
+		for (k = 0; k < len; k++) {
+			unsigned int bits;
+
+			if (!fb_is_printable(s[k])) {
+				continue;
+			}
+
+			bits = font[(s[k] - FONT_FIRST_CHAR) * FONT_HEIGHT + i];
+			if (fb_cpp == 2) {
+				memcpy(d, fb_nibble16[bits >> 4], sizeof(fb_nibble16[0]));
+				memcpy(d + sizeof(fb_nibble16[0]), fb_nibble16[bits & 0xf],
+				       sizeof(fb_nibble16[0]));
+			} else { /* fb_cpp == 4 */
+				memcpy(d, fb_nibble32[bits >> 4], sizeof(fb_nibble32[0]));
+				memcpy(d + sizeof(fb_nibble32[0]), fb_nibble32[bits & 0xf],
+				       sizeof(fb_nibble32[0]));
+			}
+
+			d += FONT_WIDTH * fb_cpp;
+		}
+
+		flush_dcache_range((uintptr_t)pix, width);
+	}
+}
+#endif
+
 void fb_print(void *fb_base, const modeline_t *mode, int fb_cpp, int row, int col, const char *s)
 {
 #ifndef ARMTF_NO_PRINT
-	int i, j, ch, line_width, char_width, max_cols, max_rows;
-	const uint8_t *f;
-	unsigned int color;
-	uint8_t *pix;
+	int line_width, max_cols, max_rows;
 	int x = col;
 	int y = row;
 
-	if (!fb_base || !mode || !s || (fb_cpp != 2 && fb_cpp != 4) || FONT_WIDTH > 8) {
+	if (!fb_base || !mode || !s || (fb_cpp != 2 && fb_cpp != 4)) {
 		return;
 	}
 
 	line_width = mode->hact * fb_cpp;
-	char_width = FONT_WIDTH * fb_cpp;
 	max_cols = mode->hact / FONT_WIDTH;
 	max_rows = mode->vact / FONT_HEIGHT;
-	while ((ch = *s++) && x < max_cols && y < max_rows) {
-		if (ch == '\n') {
+	while (*s && x < max_cols && y < max_rows) {
+		const char *start = s;
+		int n = 0;
+
+		if (*s == '\n') {
 			x = 0;
 			y++;
-		} else if (ch >= FONT_FIRST_CHAR && ch <= FONT_LAST_CHAR) {
-			pix = fb_base + y * FONT_HEIGHT * line_width + x * char_width;
-			f = &font[(ch - FONT_FIRST_CHAR) * FONT_HEIGHT];
-			for (i = 0; i < FONT_HEIGHT; i++) {
-				for (j = 1 << (FONT_WIDTH - 1); j > 0; j >>= 1) {
-					color = (*f & j) ? 0xffffffff : 0;
-					if (fb_cpp == 2) {
-						*((uint16_t *)pix) = color;
-					} else { /* fb_cpp == 4 */
-						*((uint32_t *)pix) = color;
-					}
-					pix += fb_cpp;
-				}
-				pix += line_width - char_width;
-				f++;
+			s++;
+			continue;
+		}
+
+		/* The rest of the text line, clipped to the screen */
+		for (; *s && *s != '\n' && x + n < max_cols; s++) {
+			if (fb_is_printable(*s)) {
+				n++;
 			}
-			x++;
 		}
+
+		fb_print_glyphs((uint8_t *)fb_base + y * FONT_HEIGHT * line_width +
+				x * FONT_WIDTH * fb_cpp,
+				line_width, fb_cpp, start, s - start, n);
+		x += n;
 	}
 #endif
-	flush_dcache_range((uintptr_t)fb_base, mode->hact * fb_cpp * mode->vact);
 }
 
 void print_sdk_version(uintptr_t fb_base, const modeline_t *mode, int w1, int h1, const char *version)
@@ -899,6 +1060,7 @@ void print_sdk_version(uintptr_t fb_base, const modeline_t *mode, int w1, int h1
 void early_splash(uintptr_t vdu_base, uintptr_t fb_base, const modeline_t *mode, int fb_cpp, const char *msg)
 {
 	zero_normalmem((void *)fb_base, mode->hact * mode->vact * fb_cpp);
+	flush_dcache_range(fb_base, mode->hact * mode->vact * fb_cpp);
 	if (msg) {
 		fb_print((void *) fb_base, mode, fb_cpp, 0, 0, msg);
 	}
@@ -934,12 +1096,15 @@ void display_logo_and_version(uintptr_t vdu_base, uintptr_t fb_base, const model
 	mmio_write_32(vdu_base + BAIKAL_VDU_CR1, reg);
 
 	/* We do not support 16-bit and lower color resolutions here */
-	if (bmp_get_cpp(logo) == 4) {
+	if (rle_logo_to_fb(fb_base, mode, logo, 0, 0, 1)) {
+		rle_logo_get_dimensions(logo, &w1, &h1);
+	} else if (bmp_get_cpp(logo) == 4) {
 		/* Put SDK version just below the logo, aligned to its right edge */
 		bmp_to_fb(fb_base, mode, logo, 0, 0, 1);
 		bmp_get_dimensions(logo, &w1, &h1);
 	} else {
 		zero_normalmem((void *)fb_base, mode->hact * mode->vact * 4);
+		flush_dcache_range(fb_base, mode->hact * mode->vact * 4);
 	}
 #ifdef SDK_VERSION
 	print_sdk_version(fb_base, mode, w1, h1, sdk_version);
@@ -54,6 +54,23 @@ typedef struct {
 	uint16_t bpp : 16;
 } bmp_header_t;
 
+/*
+ * Run-length encoded logo, see tools/baikal/logo_pack.py. The header is
+ * followed by 24-bpp rows, top row first. Each row is a sequence of packets:
+ * a control byte with bit 7 set is followed by one pixel to repeat
+ * (bits 6..0) + 1 times, otherwise (bits 6..0) + 1 literal pixels follow.
+ */
+#define RLE_LOGO_MAGIC		0x454c524c /* "LRLE" */
+#define RLE_LOGO_REPEAT		0x80
+#define RLE_LOGO_COUNT_MASK	0x7f
+
+typedef struct {
+	uint32_t magic;
+	uint16_t width;
+	uint16_t height;
+	uint32_t data_size;
+} rle_logo_header_t;
+
 extern const modeline_t hdmi_video_mode;
 extern const modeline_t lvds_video_mode;
 extern char sdk_version[];
@@ -66,6 +83,8 @@ void hdmi_early_splash(const char *msg);
 void bmp_get_dimensions(const uint8_t *bmp_file, int *width, int *height);
 int bmp_get_cpp(const uint8_t *bmp_file);
 int bmp_to_fb(uintptr_t fb, const modeline_t *mode, const uint8_t *bmp_file, int dx, int dy, int clear_screen);
+int rle_logo_get_dimensions(const uint8_t *logo, int *width, int *height);
+int rle_logo_to_fb(uintptr_t fb, const modeline_t *mode, const uint8_t *logo, int dx, int dy, int clear_screen);
 void vdu_init(uint64_t vdu_base, uint32_t fb_base, const modeline_t *mode);
 void vdu_set_fb(uint64_t vdu_base, uint32_t fb_base, const modeline_t *mode, int fb_cpp);
 int fdt_get_panel(modeline_t *modeline);
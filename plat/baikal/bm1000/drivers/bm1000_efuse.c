@@ -11,36 +11,39 @@
 
 int64_t efuse_get_lot(void)
 {
+	uint64_t val;
 	int err;
 
-	err = scp_cmd('I', 0, 0);
+	err = scp_cmd_xfer('I', 0, 0, NULL, &val, sizeof(val));
 	if (err) {
 		return err;
 	}
 
-	return *(uint64_t *)scp_buf();
+	return val;
 }
 
 int32_t efuse_get_mac(void)
 {
+	uint32_t val;
 	int err;
 
-	err = scp_cmd('M', 0, 0);
+	err = scp_cmd_xfer('M', 0, 0, NULL, &val, sizeof(val));
 	if (err) {
 		return err;
 	}
 
-	return *(uint32_t *)scp_buf();
+	return val;
 }
 
 int32_t efuse_get_serial(void)
 {
+	uint32_t val;
 	int err;
 
-	err = scp_cmd('N', 0, 0);
+	err = scp_cmd_xfer('N', 0, 0, NULL, &val, sizeof(val));
 	if (err) {
 		return err;
 	}
 
-	return *(uint32_t *)scp_buf();
+	return val;
 }
@@ -5,11 +5,15 @@
  */
 
 #include <errno.h>
+#include <stddef.h>
+#include <string.h>
 
 #include <arch_helpers.h>
 #include <common/debug.h>
 #include <drivers/delay_timer.h>
+#include <lib/bakery_lock.h>
 #include <lib/mmio.h>
+#include <lib/utils_def.h>
 
 #include <baikal_def.h>
 #include <baikal_scp.h>
@@ -45,20 +49,36 @@ static bool scp_busy(void)
 		(scp->st != 'E' && scp->st != 'G');
 }
 
-int scp_cmd(uint8_t op, uint32_t arg0, uint32_t arg1)
+#define SCP_CMD_TIMEOUT_US	1000000
+
+/*
+ * There is a single request window, so the cores take turns: the bakery
+ * lock serves them in the order they have come. The window data are copied
+ * in and out while the lock is held. Only BL31 runs on several cores.
+ */
+#ifdef IMAGE_BL31
+DEFINE_BAKERY_LOCK(scp_lock);
+#define scp_lock_get()		bakery_lock_get(&scp_lock)
+#define scp_lock_release()	bakery_lock_release(&scp_lock)
+#else
+#define scp_lock_get()
+#define scp_lock_release()
+#endif
+
+/* Command sent by scp_cmd_start(), its result is not collected yet */
+static bool scp_async_pending;
+static int scp_async_err;
+static uint64_t scp_async_timeout;
+
+static int scp_post(uint8_t op, uint32_t arg0, uint32_t arg1)
 {
 	volatile struct scp_service *const scp =
 		(volatile struct scp_service *const)SCP_SERVICE_BASE;
 
-	int err;
 	static uint32_t id = 1;
-	char s_op[2];
-	char s_st[2];
-	uint64_t timeout;
 
 	if (scp_busy()) {
-		err = -EBUSY;
-		goto err;
+		return -EBUSY;
 	}
 
 	switch (op) {
@@ -86,8 +106,7 @@ int scp_cmd(uint8_t op, uint32_t arg0, uint32_t arg1)
 		scp->op = op;
 		break;
 	default:
-		err = -EINVAL;
-		goto err;
+		return -EINVAL;
 	}
 
 	scp->req_id = id++;
@@ -95,8 +114,122 @@ int scp_cmd(uint8_t op, uint32_t arg0, uint32_t arg1)
 	dmbst();
 
 	mmio_write_32(MAILBOX_IRB0_AP2SCP_SET, 1); /* send signal */
+	return 0;
+}
+
+static uint64_t scp_timeout_init(uint8_t op, uint32_t arg1)
+{
+	/* Erase takes a while per each flash subsector */
+	if (op == 'E') {
+		return timeout_init_us(SCP_CMD_TIMEOUT_US *
+				       div_round_up(arg1, BAIKAL_BOOT_SPI_SUBSECTOR));
+	}
+
+	return timeout_init_us(SCP_CMD_TIMEOUT_US);
+}
+
+static int scp_status(void)
+{
+	volatile struct scp_service *const scp =
+		(volatile struct scp_service *const)SCP_SERVICE_BASE;
+
+	if (scp->st != 'G') {
+		return -EFAULT;
+	}
+
+	dmbsy();
+	return 0;
+}
+
+int scp_cmd_start(uint8_t op, uint32_t arg0, uint32_t arg1,
+		  const void *in, size_t size)
+{
+	int err = -EBUSY;
+
+	scp_lock_get();
+	if (!scp_async_pending) {
+		if (in != NULL) {
+			memcpy(scp_buf(), in, size);
+		}
+
+		err = scp_post(op, arg0, arg1);
+	}
+
+	if (!err) {
+		scp_async_pending = true;
+		scp_async_err = 0;
+		scp_async_timeout = scp_timeout_init(op, arg1);
+	}
+
+	scp_lock_release();
+	return err;
+}
+
+static int scp_cmd_poll_locked(void)
+{
+	int err;
+
+	if (!scp_async_pending) {
+		/* Completed while another command was sent */
+		err = scp_async_err;
+		scp_async_err = 0;
+		return err;
+	}
+
+	if (scp_busy()) {
+		if (!timeout_elapsed(scp_async_timeout)) {
+			return -EAGAIN;
+		}
+
+		err = -ETIMEDOUT;
+	} else {
+		err = scp_status();
+	}
+
+	scp_async_pending = false;
+	return err;
+}
+
+int scp_cmd_poll(void)
+{
+	int err;
+
+	scp_lock_get();
+	err = scp_cmd_poll_locked();
+	scp_lock_release();
+	return err;
+}
 
-	timeout = timeout_init_us(1000000);
+static int scp_cmd_locked(uint8_t op, uint32_t arg0, uint32_t arg1,
+			  const void *in, void *out, size_t size, bool verbose)
+{
+	volatile struct scp_service *const scp =
+		(volatile struct scp_service *const)SCP_SERVICE_BASE;
+
+	int err;
+	char s_op[2];
+	char s_st[2];
+	uint64_t timeout;
+
+	/* Let the command in flight complete, keeping its result for the sender */
+	if (scp_async_pending) {
+		do {
+			err = scp_cmd_poll_locked();
+		} while (err == -EAGAIN);
+
+		scp_async_err = err;
+	}
+
+	if (in != NULL) {
+		memcpy(scp_buf(), in, size);
+	}
+
+	err = scp_post(op, arg0, arg1);
+	if (err) {
+		goto err;
+	}
+
+	timeout = scp_timeout_init(op, arg1);
 	while (scp_busy()) {
 		if (timeout_elapsed(timeout)) {
 			err = -ETIMEDOUT;
@@ -104,15 +237,22 @@ int scp_cmd(uint8_t op, uint32_t arg0, uint32_t arg1)
 		}
 	}
 
-	if (scp->st != 'G') {
-		err = -EFAULT;
+	err = scp_status();
+	if (err) {
 		goto err;
 	}
 
-	dmbsy();
+	if (out != NULL) {
+		memcpy(out, scp_buf(), size);
+	}
+
 	return 0;
 
 err:
+	if (!verbose) {
+		return err;
+	}
+
 	s_op[0] = op;
 	s_op[1] = '\0';
 	s_st[0] = scp->st;
@@ -128,3 +268,52 @@ err:
 
 	return err;
 }
+
+int scp_cmd(uint8_t op, uint32_t arg0, uint32_t arg1)
+{
+	return scp_cmd_xfer(op, arg0, arg1, NULL, NULL, 0);
+}
+
+bool scp_cmd_size_check(uint8_t op, uint32_t arg0, size_t size, size_t chunk)
+{
+	uint8_t *const buf = scp_buf();
+	bool ok = false;
+	size_t offs;
+
+	scp_lock_get();
+
+	/* A pattern in the buffer gives away a truncated reply */
+	for (offs = 0; offs < size; ++offs) {
+		buf[offs] = offs ^ 0xa5;
+	}
+
+	if (scp_cmd_locked(op, arg0, size, NULL, NULL, 0, false)) {
+		goto exit;
+	}
+
+	/* Each small reply lands before the part of the big one it is compared with */
+	for (offs = chunk; offs < size; offs += chunk) {
+		const size_t len = MIN(chunk, size - offs);
+
+		if (scp_cmd_locked(op, arg0 + offs, len, NULL, NULL, 0, false) ||
+		    memcmp(buf, buf + offs, len)) {
+			goto exit;
+		}
+	}
+
+	ok = true;
+exit:
+	scp_lock_release();
+	return ok;
+}
+
+int scp_cmd_xfer(uint8_t op, uint32_t arg0, uint32_t arg1,
+		 const void *in, void *out, size_t size)
+{
+	int err;
+
+	scp_lock_get();
+	err = scp_cmd_locked(op, arg0, arg1, in, out, size, true);
+	scp_lock_release();
+	return err;
+}
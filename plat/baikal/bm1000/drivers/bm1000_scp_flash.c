@@ -1,29 +1,77 @@
 /*
- * Copyright (c) 2018-2022, Baikal Electronics, JSC. All rights reserved.
+ * Copyright (c) 2018-2023, Baikal Electronics, JSC. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <errno.h>
 #include <stddef.h>
 #include <stdint.h>
-#include <string.h>
 
 #include <lib/utils_def.h>
 
+#include <baikal_def.h>
 #include <baikal_scp.h>
 #include <bm1000_scp_flash.h>
+#include <platform_def.h>
 
-#define SCP_FLASH_MAX_CHUNK_SIZE	UL(1024)
+#define SCP_FLASH_MIN_CHUNK_SIZE	UL(1024)
+/* Whole subsectors fitting the 16-bit size of a command */
+#define SCP_FLASH_MAX_ERASE_SIZE	UL(32 * 1024)
+
+/* Read/write and erase sizes accepted by the SCP firmware */
+static size_t scp_flash_chunk_size = SCP_FLASH_MIN_CHUNK_SIZE;
+static size_t scp_flash_erase_size = SCP_FLASH_MIN_CHUNK_SIZE;
+static bool scp_flash_probed;
 
 int scp_flash_init(void)
 {
-	return scp_cmd('T', 0, 0); /* disable trace */
+	/* The mailbox buffer spans up to the end of the shared SRAM */
+	const size_t buf_size = SHARED_SRAM_BASE + SHARED_SRAM_SIZE - (uintptr_t)scp_buf();
+	int err;
+
+	err = scp_cmd('T', 0, 0); /* disable trace */
+	if (err || scp_flash_probed) {
+		return err;
+	}
+
+	/*
+	 * Older SCP firmware moves at most 1 KiB per command and rejects or
+	 * truncates bigger requests, so probe the whole buffer with a read
+	 * checked against 1 KiB reads. The erase spans are only used along
+	 * with the bigger transfers.
+	 */
+	scp_flash_probed = true;
+	if (buf_size > SCP_FLASH_MIN_CHUNK_SIZE &&
+	    scp_cmd_size_check('R', 0, buf_size, SCP_FLASH_MIN_CHUNK_SIZE)) {
+		scp_flash_chunk_size = buf_size;
+		scp_flash_erase_size = SCP_FLASH_MAX_ERASE_SIZE;
+	}
+
+	return 0;
+}
+
+/* Partial subsectors are erased on their own, whole ones in spans */
+static size_t scp_flash_erase_chunk(uint32_t addr, size_t size)
+{
+	const size_t offs = addr % BAIKAL_BOOT_SPI_SUBSECTOR;
+
+	if (scp_flash_erase_size < BAIKAL_BOOT_SPI_SUBSECTOR) {
+		return MIN(size, scp_flash_erase_size);
+	}
+
+	if (offs || size < BAIKAL_BOOT_SPI_SUBSECTOR) {
+		return MIN(size, BAIKAL_BOOT_SPI_SUBSECTOR - offs);
+	}
+
+	return MIN(round_down(size, BAIKAL_BOOT_SPI_SUBSECTOR),
+		   scp_flash_erase_size);
 }
 
 int scp_flash_erase(uint32_t addr, size_t size)
 {
 	while (size) {
-		size_t chunk = MIN(size, SCP_FLASH_MAX_CHUNK_SIZE);
+		size_t chunk = scp_flash_erase_chunk(addr, size);
 		int err;
 
 		err = scp_cmd('E', addr, chunk);
@@ -43,15 +91,14 @@ int scp_flash_read(uint32_t addr, void *buf, size_t size)
 	uint8_t *pbuf = buf;
 
 	while (size) {
-		size_t chunk = MIN(size, SCP_FLASH_MAX_CHUNK_SIZE);
+		size_t chunk = MIN(size, scp_flash_chunk_size);
 		int err;
 
-		err = scp_cmd('R', addr, chunk);
+		err = scp_cmd_xfer('R', addr, chunk, NULL, pbuf, chunk);
 		if (err) {
 			return -1;
 		}
 
-		memcpy(pbuf, scp_buf(), chunk);
 		addr += chunk;
 		pbuf += chunk;
 		size -= chunk;
@@ -65,11 +112,10 @@ int scp_flash_write(uint32_t addr, void *data, size_t size)
 	uint8_t *pdata = data;
 
 	while (size) {
-		size_t chunk = MIN(size, SCP_FLASH_MAX_CHUNK_SIZE);
+		size_t chunk = MIN(size, scp_flash_chunk_size);
 		int err;
 
-		memcpy(scp_buf(), pdata, chunk);
-		err = scp_cmd('W', addr, chunk);
+		err = scp_cmd_xfer('W', addr, chunk, pdata, NULL, chunk);
 		if (err) {
 			return err;
 		}
@@ -81,3 +127,29 @@ int scp_flash_write(uint32_t addr, void *data, size_t size)
 
 	return 0;
 }
+
+/* Returns 1 while the last erase or write step is in progress */
+int scp_flash_busy(void)
+{
+	const int err = scp_cmd_poll();
+
+	return err == -EAGAIN ? 1 : err;
+}
+
+int scp_flash_erase_step(uint32_t addr, size_t size)
+{
+	const size_t chunk = scp_flash_erase_chunk(addr, size);
+	int err;
+
+	err = scp_cmd_start('E', addr, chunk, NULL, 0);
+	return err ? err : (int)chunk;
+}
+
+int scp_flash_write_step(uint32_t addr, void *data, size_t size)
+{
+	const size_t chunk = MIN(size, scp_flash_chunk_size);
+	int err;
+
+	err = scp_cmd_start('W', addr, chunk, data, chunk);
+	return err ? err : (int)chunk;
+}
@@ -14,5 +14,8 @@ int scp_flash_init(void);
 int scp_flash_erase(uint32_t addr, size_t size);
 int scp_flash_read(uint32_t addr, void *buf, size_t size);
 int scp_flash_write(uint32_t addr, void *data, size_t size);
+int scp_flash_busy(void);
+int scp_flash_erase_step(uint32_t addr, size_t size);
+int scp_flash_write_step(uint32_t addr, void *data, size_t size);
 
 #endif /* BM1000_SCP_FLASH_H */
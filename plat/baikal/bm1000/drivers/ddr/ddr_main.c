@@ -8,6 +8,7 @@
 #include <drivers/delay_timer.h>
 #include <lib/mmio.h>
 
+#include <baikal_boot_timeline.h>
 #include <bm1000_def.h>
 
 #include "ddr_lcru.h"
@@ -40,6 +41,7 @@ static int ddr_port_init(int port, bool dual_mode)
 	struct ddr_configuration data = {0};
 	struct ddr_local_conf *cfg = (struct ddr_local_conf *)spd_content.content[port].user;
 
+	baikal_boot_ts(BAIKAL_TS_DDR_PORT_START + port);
 	if (ddr_config_by_spd(port, &data)) {
 		goto error;
 	}
@@ -86,10 +88,13 @@ static int ddr_port_init(int port, bool dual_mode)
 		goto failed;
 	}
 
+	baikal_boot_ts(BAIKAL_TS_DDR_PORT_TRAINED + port);
 	if (data.ecc_on) {
 		ddr_init_ecc_memory(port);
 	}
 
+	baikal_boot_ts(BAIKAL_TS_DDR_PORT_READY + port);
+
 	spd_content.speed_mts[port] = data.clock_mhz * 2;
 
 	INFO("DIMM%u: module rate %u MHz, AA-RCD-RP-RAS %u-%u-%u-%u\n", port,
@@ -112,6 +117,8 @@ int dram_init(void)
 #ifdef BAIKAL_QEMU
 	return 0;
 #endif
+	baikal_boot_ts(BAIKAL_TS_DDR_INIT_START);
+	baikal_boot_ts(BAIKAL_TS_SPD_READ_START);
 	if (ddr_read_spd(0) != NULL) {
 		if (spd_content.content[0].mem_type == SPD_MEMTYPE_DDR4) {
 			INFO("DIMM0: DDR4 SDRAM is detected\n");
@@ -130,6 +137,7 @@ int dram_init(void)
 		}
 	}
 
+	baikal_boot_ts(BAIKAL_TS_SPD_READ_END);
 	ddr_conf(conf);
 
 	if (conf & 0x1) {
@@ -151,6 +159,7 @@ int dram_init(void)
 	}
 
 	tzc_set_transparent(conf);
+	baikal_boot_ts(BAIKAL_TS_DDR_INIT_END);
 	return 0;
 
 error:
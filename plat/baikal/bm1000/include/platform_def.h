@@ -50,10 +50,17 @@
 #define CACHE_WRITEBACK_SHIFT		U(6)
 #define CACHE_WRITEBACK_GRANULE		(U(1) << CACHE_WRITEBACK_SHIFT)
 
+#ifdef IMAGE_BL31
+/* Reserve room for the dynamically mapped flash and PVT shared buffers */
+#define MAX_MMAP_REGIONS		18
+#define MAX_XLAT_TABLES			14
+#else
 #define MAX_MMAP_REGIONS		16
 #define MAX_XLAT_TABLES			8
+#endif
 #define MAX_IO_DEVICES			3
 #define MAX_IO_HANDLES			6
+#define MAX_IO_BLOCK_DEVICES		1
 
 /* Partition memory into secure ROM, non-secure DRAM, secure "SRAM", and secure DRAM */
 #define NS_DRAM0_BASE			0x80000000
@@ -114,6 +121,10 @@
  */
 #define PLAT_DDR_SPD_BASE		(BAIKAL_FIP_BASE - 0x600)
 
+/* Boot timeline points shared by BL1, BL2 and BL31, just below the SPD data */
+#define BAIKAL_BOOT_TIMELINE_SIZE	0x200
+#define BAIKAL_BOOT_TIMELINE_BASE	(PLAT_DDR_SPD_BASE - BAIKAL_BOOT_TIMELINE_SIZE)
+
 #define BL1_RO_BASE			SHARED_SRAM_BASE
 #define BL1_RO_SIZE			0xd000
 #define BL1_RO_LIMIT			(SHARED_SRAM_BASE + BL1_RO_SIZE)
@@ -62,11 +62,28 @@ else
 $(error "Error: unknown BAIKAL_TARGET=${BAIKAL_TARGET}")
 endif
 
+ifneq ($(BAIKAL_CRC_BENCH),)
+$(eval $(call add_define,BAIKAL_CRC_BENCH))
+endif
+
+ifneq ($(BAIKAL_SPI_FLASH_BENCH),)
+$(eval $(call add_define,BAIKAL_SPI_FLASH_BENCH))
+endif
+
+ifneq ($(BAIKAL_BOOT_TIMELINE),)
+$(eval $(call add_define,BAIKAL_BOOT_TIMELINE))
+endif
+
+# The MSHC boot device is an SD card unless BAIKAL_MSHC_EMMC is set
+ifneq ($(BAIKAL_MSHC_EMMC),)
+$(eval $(call add_define,BAIKAL_MSHC_EMMC))
+endif
+
 BL1_SOURCES		+=	drivers/arm/ccn/ccn.c				\
 				drivers/delay_timer/delay_timer.c		\
 				drivers/delay_timer/generic_delay_timer.c	\
+				drivers/io/io_block.c				\
 				drivers/io/io_fip.c				\
-				drivers/io/io_memmap.c				\
 				drivers/io/io_storage.c				\
 				lib/cpus/aarch64/cortex_a57.S			\
 				plat/arm/common/arm_ccn.c			\
@@ -91,10 +108,13 @@ BL1_SOURCES		+=	drivers/arm/ccn/ccn.c				\
 override BL1_DEFAULT_LINKER_SCRIPT_SOURCE := plat/baikal/common/bl1.ld.S
 
 BL2_SOURCES		+=	common/desc_image_load.c			\
+				drivers/delay_timer/delay_timer.c		\
+				drivers/delay_timer/generic_delay_timer.c	\
+				drivers/io/io_block.c				\
 				drivers/io/io_fip.c				\
-				drivers/io/io_memmap.c				\
 				drivers/io/io_storage.c				\
 				plat/baikal/bm1000/bm1000_bl2_setup.c		\
+				plat/baikal/bm1000/drivers/bm1000_cmu.c		\
 				plat/baikal/bm1000/drivers/bm1000_smbus.c	\
 				plat/baikal/bm1000/dt.c				\
 				plat/baikal/common/baikal_bl2_mem_params_desc.c	\
@@ -150,6 +170,12 @@ ifeq (${ENABLE_PMF}, 1)
 BL31_SOURCES		+=	lib/pmf/pmf_smc.c
 endif
 
+ifneq ($(BAIKAL_BOOT_TIMELINE),)
+BL1_SOURCES		+=	plat/baikal/common/baikal_boot_timeline.c
+BL2_SOURCES		+=	plat/baikal/common/baikal_boot_timeline.c
+BL31_SOURCES		+=	plat/baikal/common/baikal_boot_timeline.c
+endif
+
 ifeq ($(notdir $(CC)),armclang)
 TF_CFLAGS_aarch64	+=	-mcpu=cortex-a57
 else ifneq ($(findstring clang,$(notdir $(CC))),)
@@ -195,4 +221,5 @@ BL1_CPPFLAGS += -march=armv8-a+crc
 BL2_CPPFLAGS += -march=armv8-a+crc
 BL2U_CPPFLAGS += -march=armv8-a+crc
 BL31_CPPFLAGS += -march=armv8-a+crc
+BL31_CPPFLAGS += -DPLAT_XLAT_TABLES_DYNAMIC=1
 BL32_CPPFLAGS += -march=armv8-a+crc
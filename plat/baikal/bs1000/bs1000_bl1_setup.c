@@ -12,6 +12,7 @@
 #include <plat/common/platform.h>
 
 #include <baikal_bl1_stack.h>
+#include <baikal_boot_timeline.h>
 #include <baikal_bootflash.h>
 #include <baikal_console.h>
 #include <baikal_io_storage.h>
@@ -21,6 +22,10 @@
 #include <platform_def.h>
 
 int dram_init(void);
+#ifdef BAIKAL_DDR_CACHE
+void dram_cache_invalidate(void);
+void dram_cache_update(void);
+#endif
 
 static uint64_t trusted_mailbox[1 + PLATFORM_CORE_COUNT]
 	__section(".trusted_mailbox") __used;
@@ -31,6 +36,7 @@ void bl1_early_platform_setup(void)
 {
 	int err;
 
+	baikal_boot_ts(BAIKAL_TS_BL1_START);
 	baikal_console_boot_init();
 
 	assert(trusted_mailbox == (void *)BAIKAL_TRUSTED_MAILBOX_BASE);
@@ -52,8 +58,18 @@ void bl1_early_platform_setup(void)
 #endif
 	if (err) {
 		ERROR("%s: DRAM error\n", __func__);
+#ifdef BAIKAL_DDR_CACHE
+		/* fall back to full training on the next boot */
+		dram_cache_invalidate();
+#endif
 		plat_panic_handler();
 	}
+
+	baikal_boot_ts_handover();
+	baikal_boot_ts(BAIKAL_TS_MEMTEST_END);
+#ifdef BAIKAL_DDR_CACHE
+	dram_cache_update();
+#endif
 }
 
 void bl1_plat_arch_setup(void)
@@ -108,6 +124,9 @@ int bl1_plat_handle_post_image_load(unsigned int image_id)
 		return 0;
 	}
 
+	baikal_boot_ts(BAIKAL_TS_BL2_LOADED);
+	plat_baikal_io_exit();
+
 	/* Get the image descriptor */
 	image_desc = bl1_plat_get_image_desc(BL2_IMAGE_ID);
 	assert(image_desc != NULL);
@@ -8,8 +8,10 @@
 
 #include <common/bl_common.h>
 #include <common/desc_image_load.h>
+#include <drivers/generic_delay_timer.h>
 #include <lib/xlat_tables/xlat_tables_v2.h>
 
+#include <baikal_boot_timeline.h>
 #include <baikal_console.h>
 #include <baikal_def.h>
 #include <baikal_io_storage.h>
@@ -25,10 +27,14 @@ void bl2_early_platform_setup2(u_register_t arg0,
 {
 	meminfo_t *mem_layout = (meminfo_t *)arg1;
 
+	baikal_boot_ts(BAIKAL_TS_BL2_START);
 	baikal_console_boot_init();
 
 	/* Setup the BL2 memory layout */
 	bl2_tzram_layout = *mem_layout;
+
+	/* The boot device drivers are used to load images from the FIP */
+	generic_delay_timer_init();
 	plat_baikal_io_setup();
 }
 
@@ -51,6 +57,10 @@ void bl2_plat_arch_setup(void)
 				SEC_DRAM_SIZE,
 				MT_MEMORY | MT_RW | MT_SECURE),
 
+		MAP_REGION_FLAT(QSPI1_BASE,
+				QSPI1_SIZE,
+				MT_DEVICE | MT_RW | MT_SECURE),
+
 		MAP_REGION_FLAT(UART_A1_BASE,
 				UART_A1_SIZE,
 				MT_DEVICE | MT_RW | MT_SECURE),
@@ -68,6 +78,8 @@ void bl2_plat_arch_setup(void)
 
 int bl2_plat_handle_post_image_load(unsigned int image_id)
 {
+	baikal_boot_ts_image_loaded(image_id);
+
 	if (image_id == BL33_IMAGE_ID) {
 		unsigned int mode;
 		bl_mem_params_node_t *bl_mem_params = get_bl_mem_params_node(image_id);
@@ -10,7 +10,9 @@
 #include <lib/mmio.h>
 #include <lib/xlat_tables/xlat_tables_v2.h>
 
+#include <baikal_boot_timeline.h>
 #include <baikal_def.h>
+#include <baikal_dram_zero.h>
 #include <baikal_gicv3.h>
 #include <bs1000_cmu.h>
 #include <bs1000_coresight.h>
@@ -21,7 +23,9 @@
 
 #include "bs1000_pcie.h"
 
-void baikal_fdt_memory_update(void);
+unsigned int baikal_dram_regions_get(uint64_t region_descs[4][2]);
+void baikal_fdt_memory_update(const uint64_t region_descs[][2],
+			      const unsigned int region_num);
 void baikal_fdt_ddr_node_enable(void);
 
 void bl31_plat_arch_setup(void)
@@ -146,7 +150,9 @@ void bl31_plat_arch_setup(void)
 	mmio_write_32(DDR5_NIC_CFG_CTRL,	NIC_GPV_REGIONSEC_NONSECURE);
 
 	bs1000_coresight_init();
+	baikal_boot_ts(BAIKAL_TS_PCIE_INIT_START);
 	pcie_init();
+	baikal_boot_ts(BAIKAL_TS_PCIE_INIT_END);
 
 	setup_page_tables(bl_regions, plat_bs1000_mmap);
 	enable_mmu_el3(0);
@@ -154,6 +160,9 @@ void bl31_plat_arch_setup(void)
 
 void bl31_platform_setup(void)
 {
+	uint64_t region_descs[4][2];
+	unsigned int region_num;
+
 	generic_delay_timer_init();
 
 	/* Deassert resets */
@@ -214,10 +223,22 @@ void bl31_platform_setup(void)
 #endif
 
 	baikal_dimm_spd_read();
-	baikal_fdt_memory_update();
+	region_num = baikal_dram_regions_get(region_descs);
+	baikal_fdt_memory_update(region_descs, region_num);
 	baikal_fdt_ddr_node_enable();
 
+#ifdef BAIKAL_DRAM_ZERO
+	baikal_boot_ts(BAIKAL_TS_DRAM_ZERO_START);
+	if (baikal_dram_zero(region_descs, region_num)) {
+		ERROR("%s: failed to zero DRAM\n", __func__);
+	}
+	baikal_boot_ts(BAIKAL_TS_DRAM_ZERO_END);
+#endif
+
 	memcpy((void *)BAIKAL_NS_DTB_BASE,
 	       (void *)BAIKAL_SEC_DTB_BASE,
 	       BAIKAL_DTB_MAX_SIZE);
+
+	baikal_boot_ts(BAIKAL_TS_BL31_PLATFORM_SETUP_END);
+	baikal_boot_ts_print();
 }
@@ -4,6 +4,8 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <errno.h>
+#include <stdbool.h>
 #include <string.h>
 
 #include <lib/utils_def.h>
@@ -17,10 +19,45 @@
 #define DIMM_NUM	12
 #define SPD_MAXSIZE	512
 
+#define SPD_BUS_NUM	2
+#define SPD_BUS_DIMMS	(DIMM_NUM / SPD_BUS_NUM)
+
 #define SPD_SPA0	0x36
 #define SPD_SPA1	0x37
 
+#define SPD_PAGE_SIZE		256
+#define SPD_BASECONF_SIZE	128
+#define SPD_MODULE_SIZE		128
+#define SPD_MFGINFO_OFFSET	320 /* module manufacturer, date, serial and part number */
+#define SPD_MFGINFO_SIZE	29
+
+/*
+ * Each SPD bus is walked by its own state machine, so the EEPROMs on
+ * I2C2 and I2C3 are read at the same time. The page is switched once
+ * per bus instead of around every DIMM, and of page 1 only the
+ * manufacturing info is fetched: the rest of it is not used by firmware.
+ */
+enum spd_step {
+	SPD_STEP_PAGE0,
+	SPD_STEP_BASECONF,
+	SPD_STEP_MODULE,
+	SPD_STEP_PAGE1,
+	SPD_STEP_MFGINFO,
+	SPD_STEP_PAGE0_EXIT,
+	SPD_STEP_DONE
+};
+
+struct spd_bus {
+	uintptr_t base;
+	unsigned int first_dimm;
+	unsigned int dimm_idx;
+	enum spd_step step;
+	uint8_t startaddr;
+	struct i2c_xfer xfer;
+};
+
 static uint8_t spd_data[DIMM_NUM][SPD_MAXSIZE];
+static bool spd_page1[DIMM_NUM];
 
 const void *baikal_dimm_spd_get(const unsigned int dimm_idx)
 {
@@ -31,60 +68,147 @@ const void *baikal_dimm_spd_get(const unsigned int dimm_idx)
 	return spd_data[dimm_idx];
 }
 
-void baikal_dimm_spd_read(void)
+static void spd_bus_xfer_start(struct spd_bus *const bus)
 {
-	unsigned int dimm_idx;
-
-	for (dimm_idx = 0; dimm_idx < ARRAY_SIZE(spd_data); ++dimm_idx) {
-		const uintptr_t base = dimm_idx < 6 ? I2C2_BASE : I2C3_BASE;
-		uint8_t *buf = spd_data[dimm_idx];
-		int rxsize;
-		const unsigned int spd_addr = 0x50 + dimm_idx % 6;
-		uint8_t startaddr = 0;
-
-		memset(buf, 0xff, sizeof(spd_data[0]));
+	uint8_t *const buf = spd_data[bus->dimm_idx];
+	const unsigned int spd_addr = 0x50 + bus->dimm_idx % SPD_BUS_DIMMS;
+
+	switch (bus->step) {
+	case SPD_STEP_PAGE0:
+	case SPD_STEP_PAGE0_EXIT:
+	case SPD_STEP_PAGE1:
+		bus->startaddr = 0;
+		i2c_xfer_start(&bus->xfer, bus->base, BAIKAL_I2C_ICLK_FREQ,
+			       bus->step == SPD_STEP_PAGE1 ? SPD_SPA1 : SPD_SPA0,
+			       &bus->startaddr, sizeof(bus->startaddr),
+			       NULL, 0);
+		break;
+	case SPD_STEP_BASECONF:
+		bus->startaddr = 0;
+		i2c_xfer_start(&bus->xfer, bus->base, BAIKAL_I2C_ICLK_FREQ,
+			       spd_addr,
+			       &bus->startaddr, sizeof(bus->startaddr),
+			       buf, SPD_BASECONF_SIZE);
+		break;
+	case SPD_STEP_MODULE:
+		bus->startaddr = SPD_BASECONF_SIZE;
+		i2c_xfer_start(&bus->xfer, bus->base, BAIKAL_I2C_ICLK_FREQ,
+			       spd_addr,
+			       &bus->startaddr, sizeof(bus->startaddr),
+			       buf + SPD_BASECONF_SIZE, SPD_MODULE_SIZE);
+		break;
+	case SPD_STEP_MFGINFO:
+		bus->startaddr = SPD_MFGINFO_OFFSET - SPD_PAGE_SIZE;
+		i2c_xfer_start(&bus->xfer, bus->base, BAIKAL_I2C_ICLK_FREQ,
+			       spd_addr,
+			       &bus->startaddr, sizeof(bus->startaddr),
+			       buf + SPD_MFGINFO_OFFSET, SPD_MFGINFO_SIZE);
+		break;
+	default:
+		break;
+	}
+}
 
-		i2c_txrx(base, BAIKAL_I2C_ICLK_FREQ,
-			 SPD_SPA0,
-			 &startaddr, sizeof(startaddr),
-			 NULL, 0);
+/* Find the next DIMM of the bus, starting from dimm_idx, with SPD page 1 */
+static bool spd_bus_next_page1(struct spd_bus *const bus)
+{
+	for (; bus->dimm_idx < bus->first_dimm + SPD_BUS_DIMMS; ++bus->dimm_idx) {
+		if (spd_page1[bus->dimm_idx]) {
+			return true;
+		}
+	}
 
-		rxsize = i2c_txrx(base, BAIKAL_I2C_ICLK_FREQ,
-				  spd_addr,
-				  &startaddr, sizeof(startaddr),
-				  buf, 128);
+	return false;
+}
 
-		if (rxsize == 128 &&
+static void spd_bus_xfer_done(struct spd_bus *const bus, const int rxsize)
+{
+	const uint8_t *const buf = spd_data[bus->dimm_idx];
+
+	switch (bus->step) {
+	case SPD_STEP_PAGE0:
+		bus->dimm_idx = bus->first_dimm;
+		bus->step = SPD_STEP_BASECONF;
+		return;
+	case SPD_STEP_BASECONF:
+		if (rxsize == SPD_BASECONF_SIZE &&
 		    crc16(buf, 126, 0) == spd_get_baseconf_crc(buf)) {
 			const unsigned int bytes_used = buf[0] & 0xf;
 
 			if (bytes_used > 1 && bytes_used < 5) {
-				buf += rxsize;
-				startaddr += rxsize;
-				rxsize = i2c_txrx(base, BAIKAL_I2C_ICLK_FREQ,
-						  spd_addr,
-						  &startaddr, sizeof(startaddr),
-						  buf, 128);
-
-				if (rxsize == 128 && bytes_used > 2) {
-					buf += rxsize;
-					startaddr = 0;
-					i2c_txrx(base, BAIKAL_I2C_ICLK_FREQ,
-						 SPD_SPA1,
-						 &startaddr, sizeof(startaddr),
-						 NULL, 0);
-
-					i2c_txrx(base, BAIKAL_I2C_ICLK_FREQ,
-						 spd_addr,
-						 &startaddr, sizeof(startaddr),
-						 buf, bytes_used == 3 ? 128 : 256);
-
-					i2c_txrx(base, BAIKAL_I2C_ICLK_FREQ,
-						 SPD_SPA0,
-						 &startaddr, sizeof(startaddr),
-						 NULL, 0);
-				}
+				bus->step = SPD_STEP_MODULE;
+				return;
 			}
 		}
+		break;
+	case SPD_STEP_MODULE:
+		if (rxsize == SPD_MODULE_SIZE && (buf[0] & 0xf) > 2) {
+			spd_page1[bus->dimm_idx] = true;
+		}
+		break;
+	case SPD_STEP_PAGE1:
+		bus->dimm_idx = bus->first_dimm;
+		bus->step = spd_bus_next_page1(bus) ?
+			    SPD_STEP_MFGINFO : SPD_STEP_PAGE0_EXIT;
+		return;
+	case SPD_STEP_MFGINFO:
+		++bus->dimm_idx;
+		bus->step = spd_bus_next_page1(bus) ?
+			    SPD_STEP_MFGINFO : SPD_STEP_PAGE0_EXIT;
+		return;
+	case SPD_STEP_PAGE0_EXIT:
+	default:
+		bus->step = SPD_STEP_DONE;
+		return;
+	}
+
+	/* Base configuration of the DIMM is done, move on to the next slot */
+	if (++bus->dimm_idx < bus->first_dimm + SPD_BUS_DIMMS) {
+		bus->step = SPD_STEP_BASECONF;
+	} else {
+		bus->dimm_idx = bus->first_dimm;
+		bus->step = spd_bus_next_page1(bus) ?
+			    SPD_STEP_PAGE1 : SPD_STEP_DONE;
+	}
+}
+
+void baikal_dimm_spd_read(void)
+{
+	struct spd_bus buses[SPD_BUS_NUM] = {
+		{ .base = I2C2_BASE, .first_dimm = 0 },
+		{ .base = I2C3_BASE, .first_dimm = SPD_BUS_DIMMS }
+	};
+	unsigned int busy;
+	unsigned int i;
+
+	memset(spd_data, 0xff, sizeof(spd_data));
+	memset(spd_page1, 0, sizeof(spd_page1));
+
+	for (i = 0; i < ARRAY_SIZE(buses); ++i) {
+		buses[i].dimm_idx = buses[i].first_dimm;
+		buses[i].step = SPD_STEP_PAGE0;
+		spd_bus_xfer_start(&buses[i]);
 	}
+
+	do {
+		busy = 0;
+		for (i = 0; i < ARRAY_SIZE(buses); ++i) {
+			struct spd_bus *const bus = &buses[i];
+			int rxsize;
+
+			if (bus->step == SPD_STEP_DONE) {
+				continue;
+			}
+
+			rxsize = i2c_xfer_poll(&bus->xfer);
+			if (rxsize != -EAGAIN) {
+				spd_bus_xfer_done(bus, rxsize);
+				spd_bus_xfer_start(bus);
+			}
+
+			if (bus->step != SPD_STEP_DONE) {
+				++busy;
+			}
+		}
+	} while (busy);
 }
@@ -5,6 +5,7 @@
  */
 
 #include <common/debug.h>
+#include <lib/utils_def.h>
 #include <lib/xlat_tables/xlat_tables_v2.h>
 #include <libfdt.h>
 
@@ -86,13 +87,40 @@ static void dt_enable_mc_node(void *fdt, const uintptr_t base)
 	}
 }
 
-void baikal_fdt_memory_update(void)
+/* Spread the detected SDRAM capacity over the DRAM regions of the memory map */
+unsigned int baikal_dram_regions_get(uint64_t region_descs[4][2])
+{
+	static const uint64_t dram_regions[4][2] = {
+		{REGION_DRAM0_BASE, REGION_DRAM0_SIZE},
+		{REGION_DRAM1_BASE, REGION_DRAM1_SIZE},
+		{REGION_DRAM2_BASE, REGION_DRAM2_SIZE},
+		{REGION_DRAM3_BASE, REGION_DRAM3_SIZE}
+	};
+	uint64_t capacity = baikal_detect_sdram_capacity();
+	unsigned int region;
+
+	for (region = 0; region < ARRAY_SIZE(dram_regions) - 1; ++region) {
+		region_descs[region][0] = dram_regions[region][0];
+		if (capacity <= dram_regions[region][1]) {
+			region_descs[region][1] = capacity;
+			return region + 1;
+		}
+
+		region_descs[region][1] = dram_regions[region][1];
+		capacity -= dram_regions[region][1];
+	}
+
+	/* the last region takes the rest */
+	region_descs[region][0] = dram_regions[region][0];
+	region_descs[region][1] = capacity;
+	return region + 1;
+}
+
+void baikal_fdt_memory_update(const uint64_t region_descs[][2],
+			      const unsigned int region_num)
 {
 	void *fdt = (void *)BAIKAL_SEC_DTB_BASE;
-	uint64_t region_descs[4][2];
-	unsigned int region_num;
 	int ret;
-	uint64_t total_capacity;
 
 	ret = fdt_open_into(fdt, fdt, BAIKAL_DTB_MAX_SIZE);
 	if (ret < 0) {
@@ -100,35 +128,6 @@ void baikal_fdt_memory_update(void)
 		return;
 	}
 
-	total_capacity = baikal_detect_sdram_capacity();
-
-	region_descs[0][0] = REGION_DRAM0_BASE;
-	region_descs[1][0] = REGION_DRAM1_BASE;
-	region_descs[2][0] = REGION_DRAM2_BASE;
-	region_descs[3][0] = REGION_DRAM3_BASE;
-
-	/* TODO: the code looks unrolled and could be folded */
-	if (total_capacity <= REGION_DRAM0_SIZE) {
-		region_descs[0][1] = total_capacity;
-		region_num = 1;
-	} else {
-		region_descs[0][1] = REGION_DRAM0_SIZE;
-		if (total_capacity <= (REGION_DRAM0_SIZE + REGION_DRAM1_SIZE)) {
-			region_descs[1][1] = total_capacity - REGION_DRAM0_SIZE;
-			region_num = 2;
-		} else {
-			region_descs[1][1] = REGION_DRAM1_SIZE;
-			if (total_capacity <= (REGION_DRAM0_SIZE + REGION_DRAM1_SIZE + REGION_DRAM2_SIZE)) {
-				region_descs[2][1] = total_capacity - (REGION_DRAM0_SIZE + REGION_DRAM1_SIZE);
-				region_num = 3;
-			} else {
-				region_descs[2][1] = REGION_DRAM2_SIZE;
-				region_descs[3][1] = total_capacity - (REGION_DRAM0_SIZE + REGION_DRAM1_SIZE + REGION_DRAM2_SIZE);
-				region_num = 4;
-			}
-		}
-	}
-
 	fdt_memory_node_set(fdt, region_descs, region_num);
 
 	ret = fdt_pack(fdt);
@@ -1,14 +1,120 @@
 /*
- * Copyright (c) 2021, Baikal Electronics, JSC. All rights reserved.
+ * Copyright (c) 2021-2023, Baikal Electronics, JSC. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <stdbool.h>
 #include <stdint.h>
 
+#include <common/debug.h>
+#include <drivers/delay_timer.h>
+#include <lib/mmio.h>
+
 #include <baikal_scp.h>
+#include <bs1000_def.h>
 #include <bs1000_scp_lcru.h>
 
+static bool scp_lcru_addr(const uint32_t addr)
+{
+	return addr >= SCP_LCRU_BASE && addr < SCP_LCRU_BASE + SCP_LCRU_SIZE;
+}
+
+static int batch_read(const uint32_t addr, uint32_t *const val)
+{
+	if (scp_lcru_addr(addr)) {
+		return scp_lcru_read(addr, val);
+	}
+
+	*val = mmio_read_32(addr);
+	return 0;
+}
+
+static int batch_write(const uint32_t addr, const uint32_t val)
+{
+	if (scp_lcru_addr(addr)) {
+		return scp_lcru_write(addr, val);
+	}
+
+	mmio_write_32(addr, val);
+	return 0;
+}
+
+int scp_lcru_batch(struct scp_lcru_op *const ops, const unsigned int num)
+{
+	/* the last known register value */
+	bool known = false;
+	uint32_t known_addr = 0;
+	uint32_t known_val = 0;
+	unsigned int i;
+
+	for (i = 0; i < num; ++i) {
+		struct scp_lcru_op *const op = &ops[i];
+		const bool hit = known && known_addr == op->addr;
+		uint32_t val = hit ? known_val : 0;
+		uint32_t tries;
+		int err = 0;
+
+		switch (op->type) {
+		case SCP_LCRU_OP_READ:
+			err = batch_read(op->addr, &val);
+			op->val = val;
+			break;
+		case SCP_LCRU_OP_WRITE:
+			val = op->val;
+			err = batch_write(op->addr, val);
+			break;
+		case SCP_LCRU_OP_CLRSET:
+			if (!hit) {
+				err = batch_read(op->addr, &val);
+				if (err) {
+					break;
+				}
+			}
+
+			if (((val & ~op->mask) | op->val) != val) {
+				val = (val & ~op->mask) | op->val;
+				err = batch_write(op->addr, val);
+			}
+			break;
+		case SCP_LCRU_OP_POLL:
+			for (tries = op->arg; ; --tries) {
+				err = batch_read(op->addr, &val);
+				if (err || (val & op->mask) == op->val) {
+					break;
+				}
+
+				if (!tries) {
+					err = -1;
+					break;
+				}
+
+				udelay(SCP_LCRU_POLL_DELAY_US);
+			}
+			break;
+		case SCP_LCRU_OP_DELAY:
+			udelay(op->arg);
+			known = false;
+			continue;
+		default:
+			err = -1;
+			break;
+		}
+
+		if (err) {
+			ERROR("%s: op %u (type %u addr 0x%x) failed\n", __func__,
+			      i, op->type, op->addr);
+			return err;
+		}
+
+		known = true;
+		known_addr = op->addr;
+		known_val = val;
+	}
+
+	return 0;
+}
+
 int scp_lcru_clrbits(const uint32_t addr, const uint32_t clr)
 {
 	int err;
@@ -37,9 +143,7 @@ int scp_lcru_clrsetbits(const uint32_t addr, const uint32_t clr, const uint32_t
 
 int scp_lcru_read(const uint32_t addr, uint32_t *const val)
 {
-	int err = scp_cmd('R', addr, 0);
-	*val = *(uint32_t *)scp_buf();
-	return err;
+	return scp_cmd_xfer('R', addr, 0, NULL, val, sizeof(*val));
 }
 
 int scp_lcru_setbits(const uint32_t addr, const uint32_t set)
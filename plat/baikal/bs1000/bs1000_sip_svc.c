@@ -60,13 +60,22 @@ static uintptr_t sip_smc_handler(uint32_t smc_fid,
 	switch (local_smc_fid) {
 	case BAIKAL_SMC_FLASH_ERASE:
 	case BAIKAL_SMC_FLASH_INIT:
+	case BAIKAL_SMC_FLASH_OP_CONTINUE:
+	case BAIKAL_SMC_FLASH_OP_START:
+	case BAIKAL_SMC_FLASH_OP_STATUS:
 	case BAIKAL_SMC_FLASH_POSITION:
 	case BAIKAL_SMC_FLASH_PULL:
 	case BAIKAL_SMC_FLASH_PUSH:
 	case BAIKAL_SMC_FLASH_READ:
+	case BAIKAL_SMC_FLASH_SHMEM_READ:
+	case BAIKAL_SMC_FLASH_SHMEM_SET:
+	case BAIKAL_SMC_FLASH_SHMEM_WRITE:
 	case BAIKAL_SMC_FLASH_WRITE:
 		ret = baikal_smc_flash_handler(smc_fid, x1, x2, x3, x4, data);
-		if (ret) {
+		if (smc_fid == BAIKAL_SMC_FLASH_OP_CONTINUE ||
+		    smc_fid == BAIKAL_SMC_FLASH_OP_STATUS) {
+			SMC_RET3(handle, ret, data[0], data[1]);
+		} else if (ret) {
 			break;
 		} else if (smc_fid == BAIKAL_SMC_FLASH_PULL) {
 			SMC_RET4(handle, data[0], data[1], data[2], data[3]);
@@ -79,6 +88,10 @@ static uintptr_t sip_smc_handler(uint32_t smc_fid,
 			ret = pvt_read_reg(x2, x3);
 		} else if (x1 == PVT_WRITE) {
 			ret = pvt_write_reg(x2, x3, x4);
+		} else if (x1 == PVT_SHMEM_SET) {
+			ret = pvt_shmem_set(x2, x3);
+		} else if (x1 == PVT_SNAPSHOT) {
+			ret = pvt_snapshot(x2);
 		} else {
 			ERROR("%s: unhandled PVT SMC, x1:0x%lx\n", __func__, x1);
 			ret = SMC_UNK;
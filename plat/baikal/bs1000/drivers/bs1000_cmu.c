@@ -14,6 +14,7 @@
 #include <drivers/delay_timer.h>
 #include <drivers/generic_delay_timer.h>
 #include <lib/mmio.h>
+#include <lib/spinlock.h>
 #include <lib/utils_def.h>
 #include <libfdt.h>
 #include <ndelay.h>
@@ -53,8 +54,27 @@ struct clk_desc {
 	const char		*name;		/* "clock-output-names" */
 	const struct clk_ops	*ops;
 	struct clk_desc		*parent;	/* "clocks"		*/
+	unsigned int		gen;		/* cmu_gen of the state	*/
+	int64_t			rate;
+	int64_t			enabled;
 };
 
+/*
+ * The rates and enable states read from the registers are kept in the
+ * descriptors until any clock is changed, a change may affect the children
+ * of the clock as well. Descriptors with an older gen are read again.
+ * The clock SMCs of all cores are served under cmu_lock.
+ */
+static unsigned int cmu_gen = 1;
+#ifdef IMAGE_BL31
+static spinlock_t cmu_lock;
+#define cmu_lock_get()		spin_lock(&cmu_lock)
+#define cmu_lock_release()	spin_unlock(&cmu_lock)
+#else
+#define cmu_lock_get()
+#define cmu_lock_release()
+#endif
+
 typedef struct {
 	uint32_t rst	:1;
 	uint32_t bypass	:1;
@@ -77,6 +97,18 @@ typedef struct {
 #define DIVF_MIN 0
 #define DIVQ_MIN 1
 
+#define CMU_PLL_RST		BIT_32(0)
+#define CMU_PLL_BYPASS		BIT_32(1)
+#define CMU_PLL_SWEN		BIT_32(2)
+#define CMU_PLL_SWRST		BIT_32(3)
+#define CMU_PLL_DIVR		GENMASK_32(9, 4)
+#define CMU_PLL_DIVF		GENMASK_32(20, 12)
+#define CMU_PLL_DIVQ		GENMASK_32(26, 24)
+#define CMU_PLL_RANGE		GENMASK_32(30, 28)
+#define CMU_PLL_LOCK		BIT_32(31)
+#define CMU_PLL_DIV_MASK	(CMU_PLL_DIVR | CMU_PLL_DIVF | \
+				 CMU_PLL_DIVQ | CMU_PLL_RANGE)
+
 typedef struct {
 	uint32_t clk_en		:1;
 	uint32_t swrst		:1;
@@ -89,6 +121,13 @@ typedef struct {
 } cmu_clkch_t;
 #define VAL_CLKDIV_MAX 255
 
+#define CMU_CLKCH_CLK_EN	BIT_32(0)
+#define CMU_CLKCH_SWRST		BIT_32(1)
+#define CMU_CLKCH_SET_CLKDIV	BIT_32(2)
+#define CMU_CLKCH_VAL_CLKDIV	GENMASK_32(11, 4)
+#define CMU_CLKCH_CLK_RDY	BIT_32(30)
+#define CMU_CLKCH_LOCK_CLKDIV	BIT_32(31)
+
 typedef struct {
 	uint32_t clk_en		:1;
 	uint32_t div_val_set	:1;
@@ -147,43 +186,92 @@ static const struct clk_ops ops_clken = {
 	.round		= cmu_clken_round_rate,
 };
 
+#define CMU_DESC_NUM	400
+
+static struct clk_desc clks[CMU_DESC_NUM];
+/* Descriptors sorted by base for the clock SMC lookups */
+static struct clk_desc *clks_by_base[CMU_DESC_NUM];
+static unsigned int clks_num;
+
 struct clk_desc *cmu_desc_get_by_idx(int idx)
 {
-	static struct clk_desc clks[400]; /* TODO: allocate memory */
-
-	if (idx >= ARRAY_SIZE(clks)) {
+	if (idx < 0 || idx >= clks_num) {
 		return NULL;
 	}
 
 	return &clks[idx];
 }
 
-struct clk_desc *cmu_desc_get_by_base(uintptr_t base)
+/* Position of the first descriptor with a base not lower than the given one */
+static unsigned int cmu_desc_find(uintptr_t base)
 {
-	struct clk_desc *clk;
-	int idx;
+	unsigned int lo = 0;
+	unsigned int hi = clks_num;
 
-	for (idx = 0; ; idx++) {
-		clk = cmu_desc_get_by_idx(idx);
-		if (!clk) {
-			break;
-		}
+	while (lo < hi) {
+		const unsigned int mid = (lo + hi) / 2;
 
-		if (clk->base == base) {
-			return clk;
+		if (clks_by_base[mid]->base < base) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
 		}
 	}
 
+	return lo;
+}
+
+struct clk_desc *cmu_desc_get_by_base(uintptr_t base)
+{
+	const unsigned int pos = cmu_desc_find(base);
+
+	if (pos < clks_num && clks_by_base[pos]->base == base) {
+		return clks_by_base[pos];
+	}
+
 	return NULL;
 }
 
+static struct clk_desc *cmu_desc_add(uintptr_t base)
+{
+	struct clk_desc *clk;
+	unsigned int pos;
+
+	if (clks_num >= ARRAY_SIZE(clks)) {
+		return NULL;
+	}
+
+	pos = cmu_desc_find(base);
+	memmove(&clks_by_base[pos + 1], &clks_by_base[pos],
+		(clks_num - pos) * sizeof(clks_by_base[0]));
+
+	clk = &clks[clks_num++];
+	clk->base = base;
+	clks_by_base[pos] = clk;
+	return clk;
+}
+
+static void cmu_desc_update(struct clk_desc *clk)
+{
+	if (clk->gen == cmu_gen) {
+		return;
+	}
+
+	clk->rate = clk->ops->get(clk->base);
+	clk->enabled = clk->ops->is_enabled(clk->base);
+	if (clk->rate >= 0 && clk->enabled >= 0) {
+		clk->gen = cmu_gen;
+	}
+}
+
 struct clk_desc *cmu_desc_create(void *fdt, int offs, int index)
 {
-	static int next;
 	uintptr_t base = 0;
 	const fdt32_t *prop;
 	int proplen;
 	struct clk_desc *clk;
+	const struct clk_ops *ops;
+	int type = CLK_TYPE_NO;
 
 	/* base */
 	prop = fdt_getprop(fdt, offs, "reg", &proplen);
@@ -220,43 +308,41 @@ struct clk_desc *cmu_desc_create(void *fdt, int offs, int index)
 		return clk;
 	}
 
-	/* new */
-	clk = cmu_desc_get_by_idx(next++);
-	if (!clk) {
-		return NULL;
-	}
-	clk->type = CLK_TYPE_NO;
-	clk->name = noname;
-
-	/* base */
-	clk->base = base;
-
 	/* type */
 	prop = fdt_getprop(fdt, offs, "type", &proplen);
 	if (proplen > 0) {
-		clk->type = fdt32_to_cpu(prop[0]);
+		type = fdt32_to_cpu(prop[0]);
 	}
 
-	switch (clk->type) {
+	switch (type) {
 	case CLK_TYPE_REFCLK:
-		clk->ops = &ops_clkref;
+		ops = &ops_clkref;
 		break;
 	case CLK_TYPE_PLL:
-		clk->ops = &ops_pll;
+		ops = &ops_pll;
 		break;
 	case CLK_TYPE_CLKCH:
-		clk->ops = &ops_clkch;
+		ops = &ops_clkch;
 		break;
 	case CLK_TYPE_CLKEN:
-		clk->ops = &ops_clken;
+		ops = &ops_clken;
 		break;
 	case CLK_TYPE_CLKDIV:
-		clk->ops = &ops_clkdiv;
+		ops = &ops_clkdiv;
 		break;
 	default:
 		return NULL;
 	}
 
+	/* new */
+	clk = cmu_desc_add(base);
+	if (!clk) {
+		return NULL;
+	}
+	clk->type = type;
+	clk->name = noname;
+	clk->ops = ops;
+
 	/* name */
 	prop = fdt_getprop(fdt, offs, "clock-output-names", &proplen);
 	if (proplen > 0) {
@@ -288,6 +374,7 @@ struct clk_desc *cmu_desc_create(void *fdt, int offs, int index)
 
 		if (freq != clk->ops->get(base)) {
 			clk->ops->set(base, freq);
+			cmu_gen++;
 		}
 	}
 
@@ -414,9 +501,8 @@ int64_t cmu_get_ref(uintptr_t base)
 		return -2;
 	}
 
-	int64_t freq = parent->ops->get(parent->base);
-
-	return freq;
+	cmu_desc_update(parent);
+	return parent->rate;
 }
 
 int64_t cmu_pll_calc(int64_t fref, void *div)
@@ -862,49 +948,8 @@ int64_t cmu_pll_get_rate(uintptr_t base)
 
 int64_t cmu_pll_set_rate(uintptr_t base, int64_t freq)
 {
+	cmu_pll_t div = {0};
 	uint32_t raw;
-	cmu_pll_t *reg = (void *)&raw;
-	int ret;
-
-	/* 1. SWEN = 0 */
-	ret = reg_read(base, &raw);
-	if (ret < 0) {
-		return ret;
-	}
-	reg->swen = 0;
-	ret = reg_write(base, raw);
-	if (ret < 0) {
-		return ret;
-	}
-
-	/* 2. BYPASS = 1, RST = 1 */
-	ret = reg_read(base, &raw);
-	if (ret < 0) {
-		return ret;
-	}
-	reg->bypass = 1;
-	reg->rst = 1;
-	ret = reg_write(base, raw);
-	if (ret < 0) {
-		return ret;
-	}
-
-	/*3. wait */
-	udelay(10);
-
-	/* 4. BYPASS = 0 */
-	ret = reg_read(base, &raw);
-	if (ret < 0) {
-		return ret;
-	}
-	reg->bypass = 0;
-	ret = reg_write(base, raw);
-	if (ret < 0) {
-		return ret;
-	}
-
-	/* 5. set_div */
-	cmu_pll_t div;
 	int64_t fref = cmu_get_ref(base);
 
 	if (fref < 0) {
@@ -915,60 +960,33 @@ int64_t cmu_pll_set_rate(uintptr_t base, int64_t freq)
 		return -1;
 	}
 
-	if (cmu_pll_div_set(base, &div)) {
-		return -1;
-	}
-
-	/* 6. RST = 0 */
-	ret = reg_read(base, &raw);
-	if (ret < 0) {
-		return ret;
-	}
-	reg->rst = 0;
-	ret = reg_write(base, raw);
-	if (ret < 0) {
-		return ret;
-	}
-
-	/* 7. wait */
-	/* 8. LOCK? */
+	memcpy(&raw, &div, sizeof(raw));
+
+	struct scp_lcru_op ops[] = {
+		/* 1. SWEN = 0 */
+		SCP_LCRU_CLRSET(base, CMU_PLL_SWEN, 0),
+		/* 2. BYPASS = 1, RST = 1 */
+		SCP_LCRU_CLRSET(base, 0, CMU_PLL_BYPASS | CMU_PLL_RST),
+		/* 3. wait */
+		SCP_LCRU_DELAY(10),
+		/* 4. BYPASS = 0 */
+		SCP_LCRU_CLRSET(base, CMU_PLL_BYPASS, 0),
+		/* 5. set_div */
+		SCP_LCRU_CLRSET(base, CMU_PLL_DIV_MASK, raw & CMU_PLL_DIV_MASK),
+		/* 6. RST = 0 */
+		SCP_LCRU_CLRSET(base, CMU_PLL_RST, 0),
+		/* 7. wait */
+		/* 8. LOCK? */
 #ifndef BAIKAL_QEMU
-	int try = 100;
-
-	do {
-		ret = reg_read(base, &raw);
-		if (ret < 0) {
-			return ret;
-		}
-		udelay(10);
-		if (!try--) {
-			return -1;
-		}
-	} while (!reg->lock);
+		SCP_LCRU_POLL(base, CMU_PLL_LOCK, CMU_PLL_LOCK, 100),
 #endif
-	/* 9. SWEN = 1 */
-	ret = reg_read(base, &raw);
-	if (ret < 0) {
-		return ret;
-	}
-	reg->swen = 1;
-	ret = reg_write(base, raw);
-	if (ret < 0) {
-		return ret;
-	}
+		/* 9. SWEN = 1 */
+		SCP_LCRU_CLRSET(base, 0, CMU_PLL_SWEN),
+		/* 10. SWRST = 0 */
+		SCP_LCRU_CLRSET(base, CMU_PLL_SWRST, 0)
+	};
 
-	/* 10. SWRST = 0 */
-	ret = reg_read(base, &raw);
-	if (ret < 0) {
-		return ret;
-	}
-	reg->swrst = 0;
-	ret = reg_write(base, raw);
-	if (ret < 0) {
-		return ret;
-	}
-
-	return 0;
+	return scp_lcru_batch(ops, ARRAY_SIZE(ops));
 }
 
 int64_t cmu_pll_disable(uintptr_t base)
@@ -1066,30 +1084,8 @@ int64_t cmu_clkch_get_rate(uintptr_t base)
 
 int64_t cmu_clkch_set_rate(uintptr_t base, int64_t freq)
 {
+	cmu_clkch_t div = {0};
 	uint32_t raw;
-	cmu_clkch_t *reg = (void *)&raw;
-	int ret;
-
-	/* 1. CLKEN = 0 */
-	cmu_clkch_disable(base);
-
-	/* 2. wait CLKRDY = 0 */
-#ifndef BAIKAL_QEMU
-	int try = 100;
-
-	do {
-		ret = reg_read(base, &raw);
-		if (ret < 0) {
-			return ret;
-		}
-		udelay(10);
-		if (!try--) {
-			return -1;
-		}
-	} while (reg->clk_rdy);
-#endif
-	/* 3. set dividers */
-	cmu_clkch_t div;
 	int64_t fref = cmu_get_ref(base);
 
 	if (fref < 0) {
@@ -1100,64 +1096,36 @@ int64_t cmu_clkch_set_rate(uintptr_t base, int64_t freq)
 		return -1;
 	}
 
-	if (cmu_clkch_div_set(base, &div)) {
-		return -1;
-	}
+	memcpy(&raw, &div, sizeof(raw));
 
-	/* 4. SET_CLKDIV = 1 */
-	ret = reg_read(base, &raw);
-	if (ret < 0) {
-		return ret;
-	}
-	reg->set_clkdiv = 1;
-	ret = reg_write(base, raw);
-	if (ret < 0) {
-		return ret;
-	}
-
-	/* 5. wait LOCK_CLKDIV */
+	struct scp_lcru_op ops[] = {
+		/* 1. CLKEN = 0 */
+		SCP_LCRU_CLRSET(base, CMU_CLKCH_CLK_EN, 0),
+		/* 2. wait CLKRDY = 0 */
 #ifndef BAIKAL_QEMU
-	try = 100;
-	do {
-		ret = reg_read(base, &raw);
-		if (ret < 0) {
-			return ret;
-		}
-		udelay(10);
-		if (!try--) {
-			return -1;
-		}
-	} while (!reg->lock_clkdiv);
+		SCP_LCRU_POLL(base, CMU_CLKCH_CLK_RDY, 0, 100),
 #endif
-	/* 6. CLKEN = 1 */
-	cmu_clkch_enable(base);
-
-	/* 7. wait CLKRDY = 1 */
+		/* 3. set dividers */
+		SCP_LCRU_CLRSET(base, CMU_CLKCH_VAL_CLKDIV,
+				raw & CMU_CLKCH_VAL_CLKDIV),
+		/* 4. SET_CLKDIV = 1 */
+		SCP_LCRU_CLRSET(base, 0, CMU_CLKCH_SET_CLKDIV),
+		/* 5. wait LOCK_CLKDIV */
 #ifndef BAIKAL_QEMU
-	try = 100;
-	do {
-		ret = reg_read(base, &raw);
-		if (ret < 0) {
-			return ret;
-		}
-		udelay(10);
-		if (!try--) {
-			return -1;
-		}
-	} while (!reg->clk_rdy);
+		SCP_LCRU_POLL(base, CMU_CLKCH_LOCK_CLKDIV,
+			      CMU_CLKCH_LOCK_CLKDIV, 100),
 #endif
-	/* 8. SWRST = 0 */
-	ret = reg_read(base, &raw);
-	if (ret < 0) {
-		return ret;
-	}
-	reg->swrst = 0;
-	ret = reg_write(base, raw);
-	if (ret < 0) {
-		return ret;
-	}
+		/* 6. CLKEN = 1 */
+		SCP_LCRU_CLRSET(base, 0, CMU_CLKCH_CLK_EN),
+		/* 7. wait CLKRDY = 1 */
+#ifndef BAIKAL_QEMU
+		SCP_LCRU_POLL(base, CMU_CLKCH_CLK_RDY, CMU_CLKCH_CLK_RDY, 100),
+#endif
+		/* 8. SWRST = 0 */
+		SCP_LCRU_CLRSET(base, CMU_CLKCH_SWRST, 0)
+	};
 
-	return 0;
+	return scp_lcru_batch(ops, ARRAY_SIZE(ops));
 }
 
 int64_t cmu_clkch_disable(uintptr_t base)
@@ -1546,27 +1514,45 @@ int64_t baikal_smc_clk_handler(const uint32_t smc_fid,
 	struct clk_desc *clk = cmu_desc_get_by_base(base);
 	/* Convert SMC FID to SMC64 to support SMC32/SMC64 */
 	const uint32_t local_smc_fid = BIT(30) | smc_fid;
+	int64_t ret;
 
 	if (!clk) {
 		return -1;
 	}
 
+	cmu_lock_get();
 	switch (local_smc_fid) {
 	case BAIKAL_SMC_CLK_GET:
-		return clk->ops->get(base);
+		cmu_desc_update(clk);
+		ret = clk->rate;
+		break;
 	case BAIKAL_SMC_CLK_SET:
-		return clk->ops->set(base, freq);
+		ret = clk->ops->set(base, freq);
+		/* Even a failed change may have left the registers modified */
+		cmu_gen++;
+		break;
 	case BAIKAL_SMC_CLK_ROUND:
-		return clk->ops->round(base, freq);
+		ret = clk->ops->round(base, freq);
+		break;
 	case BAIKAL_SMC_CLK_DISABLE:
-		return clk->ops->disable(base);
+		ret = clk->ops->disable(base);
+		cmu_gen++;
+		break;
 	case BAIKAL_SMC_CLK_ENABLE:
-		return clk->ops->enable(base);
+		ret = clk->ops->enable(base);
+		cmu_gen++;
+		break;
 	case BAIKAL_SMC_CLK_IS_ENABLED:
-		return clk->ops->is_enabled(base);
+		cmu_desc_update(clk);
+		ret = clk->enabled;
+		break;
 	default:
-		return -1;
+		ret = -1;
+		break;
 	}
+
+	cmu_lock_release();
+	return ret;
 }
 
 int64_t baikal_smc_gmac_handler(const uint32_t smc_fid,
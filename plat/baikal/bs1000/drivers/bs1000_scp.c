@@ -4,11 +4,15 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <assert.h>
 #include <errno.h>
+#include <stddef.h>
+#include <string.h>
 
 #include <arch_helpers.h>
 #include <common/debug.h>
 #include <drivers/delay_timer.h>
+#include <lib/bakery_lock.h>
 #include <lib/mmio.h>
 
 #include <baikal_def.h>
@@ -28,6 +32,20 @@ struct scp_service {
 };
 #pragma pack()
 
+/*
+ * There is a single request window, so the cores take turns: the bakery
+ * lock serves them in the order they have come. The window data are copied
+ * in and out while the lock is held. Only BL31 runs on several cores.
+ */
+#ifdef IMAGE_BL31
+DEFINE_BAKERY_LOCK(scp_lock);
+#define scp_lock_get()		bakery_lock_get(&scp_lock)
+#define scp_lock_release()	bakery_lock_release(&scp_lock)
+#else
+#define scp_lock_get()
+#define scp_lock_release()
+#endif
+
 void *scp_buf(void)
 {
 	volatile struct scp_service *const scp =
@@ -46,7 +64,8 @@ static bool scp_busy(void)
 		(scp->st != 'E' && scp->st != 'G');
 }
 
-int scp_cmd(uint8_t op, uint32_t arg0, uint32_t arg1)
+static int scp_cmd_locked(uint8_t op, uint32_t arg0, uint32_t arg1,
+			  const void *in, void *out, size_t size)
 {
 	volatile struct scp_service *const scp =
 		(volatile struct scp_service *const)SCP_SERVICE_BASE;
@@ -57,6 +76,10 @@ int scp_cmd(uint8_t op, uint32_t arg0, uint32_t arg1)
 	char s_st[2];
 	uint64_t timeout;
 
+	/* The commands carry no data to the SCP, only arguments */
+	assert(in == NULL);
+	assert(size <= sizeof(scp->from_scp));
+
 	if (scp_busy()) {
 		err = -EBUSY;
 		goto err;
@@ -97,6 +120,10 @@ int scp_cmd(uint8_t op, uint32_t arg0, uint32_t arg1)
 	}
 
 	dmbsy();
+	if (out != NULL) {
+		memcpy(out, (void *)scp->from_scp, size);
+	}
+
 	return 0;
 
 err:
@@ -115,3 +142,19 @@ err:
 
 	return err;
 }
+
+int scp_cmd(uint8_t op, uint32_t arg0, uint32_t arg1)
+{
+	return scp_cmd_xfer(op, arg0, arg1, NULL, NULL, 0);
+}
+
+int scp_cmd_xfer(uint8_t op, uint32_t arg0, uint32_t arg1,
+		 const void *in, void *out, size_t size)
+{
+	int err;
+
+	scp_lock_get();
+	err = scp_cmd_locked(op, arg0, arg1, in, out, size);
+	scp_lock_release();
+	return err;
+}
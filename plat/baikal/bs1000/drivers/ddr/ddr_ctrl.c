@@ -692,10 +692,8 @@ void ctrl_complete_phy_init(int port, struct ddr_configuration *data)
 	BS_DDRC_WRITE(port, RFSHCTL3, 0x0);
 }
 
-int ddr_init_ecc_memory(int port)
+void ddr_ecc_scrub_start(int port)
 {
-	uint32_t ret;
-	uint64_t timeout;
 	/* uMCTL2 DataBook, p.426 "Initialization Writes" */
 	/* 2. block the AXI ports from taking the transaction */
 	BS_DDRC_WRITE(port, PCTRL_0, 0x0);
@@ -711,35 +709,26 @@ int ddr_init_ecc_memory(int port)
 	/* enable scrub in a separate step to avoid race conditions */
 	sbrctl |= (1 << 0);
 	BS_DDRC_WRITE(port, SBRCTL, sbrctl);
+}
 
+bool ddr_ecc_scrub_done(int port)
+{
 	/* uMCTL2 DataBook, p.426 "Initialization Writes" */
 	/* 8. wait for all scrub writes commands have been send */
-	for (timeout = timeout_init_us(50000000);;) {
-		if (BS_DDRC_READ(port, SBRSTAT) & 0x2) {
-			break;
-		} else if (timeout_elapsed(timeout)) {
-			ERROR("%s: failed to init memory (undone)\n", __func__);
-			ret = -1;
-			goto exit;
-		}
-	}
-	for (timeout = timeout_init_us(10000);;) {
-		if (!(BS_DDRC_READ(port, SBRSTAT) & 0x1)) {
-			break;
-		} else if (timeout_elapsed(timeout)) {
-			ERROR("%s: failed to init memory (busy)\n", __func__);
-			ret = -1;
-			goto exit;
-		}
-	}
+	/* 9. wait for the scrubber to become idle */
+	const uint32_t sbrstat = BS_DDRC_READ(port, SBRSTAT);
+
+	return (sbrstat & 0x2) && !(sbrstat & 0x1);
+}
+
+void ddr_ecc_scrub_stop(int port)
+{
+	uint32_t sbrctl = BS_DDRC_READ(port, SBRCTL);
 
-exit:
 	/* 10. disable the scrubber */
 	sbrctl &= ~(1 << 0);
 	BS_DDRC_WRITE(port, SBRCTL, sbrctl);
 
 	/* 14. enable the AXI ports */
 	BS_DDRC_WRITE(port, PCTRL_0, 0x1);
-
-	return ret;
 }
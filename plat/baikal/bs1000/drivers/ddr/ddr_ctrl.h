@@ -22,5 +22,8 @@ void umctl2_enter_SR(int port);
 int ctrl_prepare_phy_init(int port);
 int ctrl_init(int port, struct ddr_configuration *data);
 void ctrl_complete_phy_init(int port, struct ddr_configuration *data);
+void ddr_ecc_scrub_start(int port);
+bool ddr_ecc_scrub_done(int port);
+void ddr_ecc_scrub_stop(int port);
 
 #endif /* DDR_CTRL_H */
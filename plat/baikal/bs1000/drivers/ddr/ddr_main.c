@@ -4,8 +4,11 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <string.h>
+
 #include <common/debug.h>
 #include <drivers/delay_timer.h>
+#include <lib/cassert.h>
 #include <lib/mmio.h>
 #include <bs1000_dimm_spd.h>
 #include <spd.h>
@@ -16,19 +19,165 @@
 #include "ddr_misc.h"
 #include "ddr_master.h"
 #include "phy/ddr_phy_main.h"
+#include "phy/ddr_phy_train_struct.h"
 
+#include <baikal_boot_timeline.h>
 #include <baikal_bootflash.h>
+#include <crc.h>
 #include <platform_def.h>
 
-#define BAIKAL_TFW_RDIMM_SIZE	55036
+#define BAIKAL_TFW_RDIMM_SIZE	DDR_FW_CONTAINER_SIZE
 #define BAIKAL_TFW_UDIMM_SIZE	53468
 #define BAIKAL_TFW_RDIMM_OFFS	BAIKAL_TFW_UDIMM_SIZE
 
-int ddr_init_ecc_memory(int port);
 int ddr_odt_configuration(const unsigned int port,
 			   struct ddr_configuration *const data);
 
-uint8_t firmware_container[55036];
+#define DDR_PORT_NUM		6
+#define DDR_ECC_INIT_TIMEOUT	50000000
+
+enum ddr_port_stage {
+	DDR_PORT_IDLE,
+	DDR_PORT_DEVINIT,	/* DRAM init with the cached training results */
+	DDR_PORT_TRAIN_1D,
+	DDR_PORT_TRAIN_2D_LOAD,	/* 1D is done, the 2D fw is not loaded yet */
+	DDR_PORT_TRAIN_2D,
+	DDR_PORT_RETRAIN,	/* cached training results are not usable */
+	DDR_PORT_ECC_INIT,	/* ECC memory initialization by the scrubber */
+	DDR_PORT_READY,
+	DDR_PORT_FAILED		/* the training fw could not be loaded */
+};
+
+CASSERT(DDR_PORT_NUM <= BAIKAL_TS_DDR_PORTS, assert_ddr_port_num);
+
+/* per-port state of the staged DDR init */
+struct ddr_port_ctx {
+	struct ddr_configuration data;
+	uint64_t timeout;	/* PMU message or ECC init timeout */
+	int stage;
+};
+
+uint8_t firmware_container[DDR_FW_CONTAINER_SIZE] __aligned(8);
+static struct ddr_port_ctx ddr_ports[DDR_PORT_NUM];
+static int fw_read_flag; /* {2,1} if fw for {r,u}dimm is in place */
+
+#ifdef BAIKAL_DDR_CACHE
+#define DDR_CACHE_MAGIC		0x43524444 /* "DDRC" */
+#define DDR_CACHE_SPD_SIZE	384 /* base, module specific and manufacturing info */
+
+struct ddr_cache_hdr {
+	uint32_t magic;
+	uint32_t key;	/* crc32 of the SPD contents and the ports configuration */
+	uint32_t ports;	/* bitmask of the cached ports */
+	uint32_t crc;	/* crc32 of the training results */
+};
+
+/* training results of all ports, kept in the boot flash */
+struct ddr_cache {
+	struct ddr_cache_hdr hdr;
+	struct training_res trn_res[DDR_PORT_NUM];
+	uint16_t csr[DDR_PORT_NUM][DDRPHY_RET_REGS_NUM];
+};
+
+CASSERT(sizeof(struct ddr_cache) <= BAIKAL_DDR_CACHE_MAX_SIZE,
+	assert_ddr_cache_size);
+CASSERT(sizeof(struct ddr_cache) <= sizeof(firmware_container),
+	assert_ddr_cache_container_size);
+CASSERT(BAIKAL_TFW_OFFSET + BAIKAL_TFW_RDIMM_OFFS + BAIKAL_TFW_RDIMM_SIZE <=
+	BAIKAL_DDR_CACHE_OFFSET, assert_ddr_cache_offset);
+
+/*
+ * The training fw is not needed when the cache is in use,
+ * so the cache shares its buffer.
+ */
+static struct ddr_cache *const ddr_cache = (struct ddr_cache *)firmware_container;
+static uint32_t ddr_cache_key;
+static uint32_t ddr_cache_ports;	/* populated ports */
+static uint32_t ddr_trained_ports;	/* ports that passed full training */
+static bool ddr_cache_used;
+
+static bool ddr_cache_lookup(void)
+{
+	struct ddr_cache_hdr hdr;
+
+	if (bootflash_read(BAIKAL_DDR_CACHE_OFFSET, &hdr, sizeof(hdr))) {
+		return false;
+	}
+
+	return hdr.magic == DDR_CACHE_MAGIC &&
+	       hdr.key   == ddr_cache_key &&
+	       hdr.ports == ddr_cache_ports;
+}
+
+static bool ddr_cache_load(void)
+{
+	fw_read_flag = 0;
+	if (bootflash_read(BAIKAL_DDR_CACHE_OFFSET, ddr_cache, sizeof(*ddr_cache))) {
+		return false;
+	}
+
+	if (ddr_cache->hdr.crc != crc32(ddr_cache->trn_res, sizeof(*ddr_cache) -
+					offsetof(struct ddr_cache, trn_res), 0)) {
+		ERROR("DDR training cache is corrupted\n");
+		return false;
+	}
+
+	return true;
+}
+
+/* Save training results once the DRAM is known to be good */
+void dram_cache_update(void)
+{
+	if (ddr_cache_used || !ddr_cache_ports ||
+	    ddr_trained_ports != ddr_cache_ports) {
+		return;
+	}
+
+	fw_read_flag = 0;
+	memset(ddr_cache, 0, sizeof(*ddr_cache));
+	ddr_cache->hdr.magic = DDR_CACHE_MAGIC;
+	ddr_cache->hdr.key = ddr_cache_key;
+	ddr_cache->hdr.ports = ddr_cache_ports;
+
+	for (int port = 0; port < DDR_PORT_NUM; ++port) {
+		if (ddr_cache_ports & (1 << port)) {
+			ddr_cache->trn_res[port] = ddr_ports[port].data.trn_res;
+			phyinit_SaveRetRegs(port, ddr_cache->csr[port]);
+		}
+	}
+
+	ddr_cache->hdr.crc = crc32(ddr_cache->trn_res, sizeof(*ddr_cache) -
+				   offsetof(struct ddr_cache, trn_res), 0);
+
+	if (bootflash_erase(BAIKAL_DDR_CACHE_OFFSET, BAIKAL_DDR_CACHE_MAX_SIZE) ||
+	    bootflash_write(BAIKAL_DDR_CACHE_OFFSET, ddr_cache, sizeof(*ddr_cache))) {
+		ERROR("Failed to save DDR training cache\n");
+		return;
+	}
+
+	INFO("DDR training results are saved\n");
+}
+
+/*
+ * Add the port configuration to the cache key. The fields are hashed
+ * explicitly rather than the whole struct: it has padding and also holds
+ * the training results. ecc_on..PHY_ODI is a run of uint32_t.
+ */
+static uint32_t ddr_cache_key_add(const struct ddr_configuration *data, uint32_t key)
+{
+	key = crc32(&data->ecc_on, offsetof(struct ddr_configuration, PHY_ODI) +
+		    sizeof(data->PHY_ODI) - offsetof(struct ddr_configuration, ecc_on), key);
+	return crc32(&data->addr_strip_bit, sizeof(data->addr_strip_bit), key);
+}
+
+/* Drop the cached training results, so the next boot runs full training */
+void dram_cache_invalidate(void)
+{
+	if (ddr_cache_used) {
+		bootflash_erase(BAIKAL_DDR_CACHE_OFFSET, BAIKAL_DDR_CACHE_MAX_SIZE);
+	}
+}
+#endif /* BAIKAL_DDR_CACHE */
 
 static uint64_t ddr_get_addr_strip_bit(int channels, int capacity_gb)
 {
@@ -115,84 +264,187 @@ static uint64_t ddr_get_addr_strip_bit(int channels, int capacity_gb)
 	return 0;
 }
 
-int ddr_port_init(int port, struct ddr4_spd_eeprom *spd,
-			int channels, int dual_channel_mode)
+#ifdef BAIKAL_DDR_FW_COMPRESSED
+/*
+ * Read the compressed training fw container. The images are inflated
+ * straight into PHY SRAM when loaded, so only the compressed data and
+ * the inflate workspace are kept in SRAM.
+ */
+static int ddr_fw_read(uint32_t offset, size_t size)
+{
+	struct ddr_fw_zhdr *const hdr = (struct ddr_fw_zhdr *)firmware_container;
+	unsigned int image;
+
+	if (bootflash_read(offset, hdr, sizeof(*hdr))) {
+		return -1;
+	}
+
+	if (hdr->magic != DDR_FW_Z_MAGIC || hdr->size < sizeof(*hdr) ||
+	    hdr->size > size || hdr->size > DDR_FW_Z_MAX_SIZE) {
+		ERROR("DDR: bad training fw container\n");
+		return -1;
+	}
+
+	for (image = 0; image < DDR_FW_IMAGE_NUM; ++image) {
+		if (hdr->image[image].offs < sizeof(*hdr) ||
+		    hdr->image[image].offs > hdr->size ||
+		    hdr->image[image].size > hdr->size - hdr->image[image].offs) {
+			ERROR("DDR: bad training fw image %u\n", image);
+			return -1;
+		}
+	}
+
+	return bootflash_read(offset + sizeof(*hdr), hdr + 1, hdr->size - sizeof(*hdr));
+}
+#else
+static int ddr_fw_read(uint32_t offset, size_t size)
+{
+	return bootflash_read(offset, firmware_container, size);
+}
+#endif
+
+static int ddr_fw_load(int registered_dimm)
 {
 	int err = 0;
-	static int fw_read_flag; /* {2,1} if fw for {r,u}dimm is in place */
-	struct ddr_configuration data = {0};
+
+	if (registered_dimm) {
+		if (fw_read_flag != 2) {
+			baikal_boot_ts(BAIKAL_TS_DDR_FW_READ_START);
+			err = ddr_fw_read(BAIKAL_TFW_OFFSET + BAIKAL_TFW_RDIMM_OFFS,
+					  BAIKAL_TFW_RDIMM_SIZE);
+			baikal_boot_ts(BAIKAL_TS_DDR_FW_READ_END);
+			fw_read_flag = 2;
+		}
+	} else {
+		if (fw_read_flag != 1) {
+			baikal_boot_ts(BAIKAL_TS_DDR_FW_READ_START);
+			err = ddr_fw_read(BAIKAL_TFW_OFFSET, BAIKAL_TFW_UDIMM_SIZE);
+			baikal_boot_ts(BAIKAL_TS_DDR_FW_READ_END);
+			fw_read_flag = 1;
+		}
+	}
+
+	if (err) {
+		ERROR("Failed to read training fw from bootflash;\n");
+		fw_read_flag = 0;
+		return -1;
+	}
+
+	return 0;
+}
+
+static int ddr_port_prepare(int port, struct ddr4_spd_eeprom *spd,
+			    int channels, int dual_channel_mode,
+			    struct ddr_configuration *data)
+{
 	int capacity_gb = spd_get_baseconf_dimm_capacity(spd) / 1024 / 1024 / 1024;
 
-	if (ddr_config_by_spd(port, spd, &data)) {
-		goto error;
+	if (ddr_config_by_spd(port, spd, data)) {
+		return -1;
 	}
 
 	/* disable CA PARITY */
-	data.par_on = 0;
+	data->par_on = 0;
 	/* disable DRAM CRC */
-	data.crc_on = 0;
+	data->crc_on = 0;
 	/* disable DRAM PHY Equalization */
-	data.phy_eql = 0;
+	data->phy_eql = 0;
 
 	if (dual_channel_mode) {
-		data.dimms = 2;
+		data->dimms = 2;
 	}
 
-	data.addr_strip_bit = ddr_get_addr_strip_bit(channels,
+	data->addr_strip_bit = ddr_get_addr_strip_bit(channels,
 		       capacity_gb * (dual_channel_mode ? 2 : 1));
-	if ((int64_t)data.addr_strip_bit < 0) {
-		goto error;
+	if ((int64_t)data->addr_strip_bit < 0) {
+		return -1;
 	}
 
-	if (ddr_odt_configuration(port, &data)) {
-		goto error;
+	if (ddr_odt_configuration(port, data)) {
+		return -1;
 	}
 
 	/* enable PHY 2D training */
-	if (data.clock_mhz >= 1200) {
-		data.phy_training_2d = 1;
+	if (data->clock_mhz >= 1200) {
+		data->phy_training_2d = 1;
 	}
 
-	if (data.clock_mhz != 800) {
-		if (ddr_lcpcmd_set_speedbin(port, data.clock_mhz)) {
-			goto error;
+	if (data->clock_mhz != 800) {
+		if (ddr_lcpcmd_set_speedbin(port, data->clock_mhz)) {
+			return -1;
 		}
 	}
 
 	ddrlcru_apb_reset_off(port);
 
-	if (ctrl_init(port, &data)) {
-		goto error;
+	if (ctrl_init(port, data)) {
+		return -1;
 	}
 
 	ddrlcru_core_reset_off(port);
 
 	ctrl_prepare_phy_init(port);
 
-	if (data.registered_dimm) {
-		if (fw_read_flag != 2) {
-			err = bootflash_read((BAIKAL_TFW_OFFSET + BAIKAL_TFW_RDIMM_OFFS),
-						firmware_container, BAIKAL_TFW_RDIMM_SIZE);
-			fw_read_flag = 2;
-		}
-	} else {
-		if (fw_read_flag != 1) {
-			err = bootflash_read((BAIKAL_TFW_OFFSET),
-						firmware_container, BAIKAL_TFW_UDIMM_SIZE);
-			fw_read_flag = 1;
-		}
+	return 0;
+}
+
+static void ddr_ports_service(void);
+
+/*
+ * Loading the training fw takes long: the ports whose fw has completed
+ * are serviced first, so their RDIMM time critical section is not delayed.
+ */
+static int ddr_port_train(int port, int training_2d)
+{
+	struct ddr_port_ctx *ctx = &ddr_ports[port];
+
+	ddr_ports_service();
+	if (ddr_fw_load(ctx->data.registered_dimm)) {
+		return -1;
 	}
 
-	if (err) {
-		ERROR("Failed to read training fw from bootflash;\n");
-		goto error;
+	if (phy_train_start(port, &ctx->data, training_2d)) {
+		return -1;
+	}
+
+	ctx->stage = training_2d ? DDR_PORT_TRAIN_2D : DDR_PORT_TRAIN_1D;
+	ctx->timeout = timeout_init_us(DDRPHY_TRAINING_TIMEOUT);
+	return 0;
+}
+
+#ifdef BAIKAL_DDR_CACHE
+static int ddr_port_devinit(int port)
+{
+	struct ddr_port_ctx *ctx = &ddr_ports[port];
+
+	ddr_ports_service();
+	if (ddr_fw_load(ctx->data.registered_dimm)) {
+		return -1;
+	}
+
+	if (phy_devinit_start(port, &ctx->data)) {
+		return -1;
 	}
 
-	phy_main(port, &data);
+	ctx->stage = DDR_PORT_DEVINIT;
+	ctx->timeout = timeout_init_us(DDRPHY_TRAINING_TIMEOUT);
+	return 0;
+}
+#endif
+
+static void ddr_port_complete(int port, int trained)
+{
+	struct ddr_port_ctx *ctx = &ddr_ports[port];
+
+	/* WARNING: this is time critical section for RDIMM (avoid any delay from PHY training complete to dfi_init_start) */
+	if (trained) {
+		phy_train_finish(port, &ctx->data);
+	}
 
-	ctrl_complete_phy_init(port, &data);
+	ctrl_complete_phy_init(port, &ctx->data);
+	baikal_boot_ts(BAIKAL_TS_DDR_PORT_TRAINED + port);
 
-	if (data.registered_dimm) {
+	if (ctx->data.registered_dimm) {
 		/* this is experimental workaround code
 		 * for some RDIMMs (like MTA18ASF2G72PZ-3G2, MTA36ASF4G72PZ-3G2)
 		 */
@@ -201,18 +453,156 @@ int ddr_port_init(int port, struct ddr4_spd_eeprom *spd,
 		umctl2_exit_SR(port); /* exit DRAM self-refresh mode */
 	}
 
-	if (data.ecc_on) {
-		ddr_init_ecc_memory(port);
+	if (ctx->data.ecc_on) {
+		/* the scrubber runs while other ports are trained */
+		ddr_ecc_scrub_start(port);
+		ctx->stage = DDR_PORT_ECC_INIT;
+		ctx->timeout = timeout_init_us(DDR_ECC_INIT_TIMEOUT);
+		return;
 	}
 
-	INFO("DIMM%u: module rate %u MHz, AA-RCD-RP-RAS %u-%u-%u-%u\n", port,
-	     data.clock_mhz * 2, data.CL, data.tRCD, data.tRP, data.tRAS);
+	ctx->stage = DDR_PORT_READY;
+	baikal_boot_ts(BAIKAL_TS_DDR_PORT_READY + port);
+}
 
-	return 0;
+/*
+ * Check the ECC memory initialization or process a pending PMU message
+ * of the port. A port whose training firmware has completed goes through
+ * the RDIMM time critical section right away. Loading the 2D firmware
+ * takes long, so it is left to ddr_ports_poll().
+ */
+static void ddr_port_service(int port)
+{
+	struct ddr_port_ctx *ctx = &ddr_ports[port];
+	int ret;
+
+	if (ctx->stage == DDR_PORT_ECC_INIT) {
+		if (ddr_ecc_scrub_done(port)) {
+			ddr_ecc_scrub_stop(port);
+			ctx->stage = DDR_PORT_READY;
+			baikal_boot_ts(BAIKAL_TS_DDR_PORT_READY + port);
+		} else if (timeout_elapsed(ctx->timeout)) {
+			ERROR("DDR port #%d: failed to init ECC memory\n", port);
+			ddr_ecc_scrub_stop(port);
+			ctx->stage = DDR_PORT_READY;
+			baikal_boot_ts(BAIKAL_TS_DDR_PORT_READY + port);
+		}
+		return;
+	}
 
-error:
-	ERROR("Failed to init DDR port #%d\n", port);
-	return -1;
+	ret = phyinit_G_PollFW(port);
+	if (ret == PHY_FW_BUSY) {
+		ctx->timeout = timeout_init_us(DDRPHY_TRAINING_TIMEOUT);
+		return;
+	} else if (ret == PHY_FW_IDLE) {
+		if (!timeout_elapsed(ctx->timeout)) {
+			return;
+		}
+		/* can't get new message from pmu */
+		ERROR("pmu timeout\n");
+	}
+
+	phyinit_G_HaltFW(port);
+
+	if (ret != PHY_FW_PASS) {
+		ERROR("DDR port #%d: PHY training failed\n", port);
+		ddr_port_complete(port, false);
+		return;
+	}
+
+#ifdef BAIKAL_DDR_CACHE
+	if (ctx->stage == DDR_PORT_DEVINIT) {
+		if (!ddr_cache_used) {
+			/* train the port when other ports are done */
+			ctx->stage = DDR_PORT_RETRAIN;
+			return;
+		}
+
+		phyinit_RestoreRetRegs(port, ddr_cache->csr[port]);
+		ctx->data.trn_res = ddr_cache->trn_res[port];
+		ddr_port_complete(port, true);
+		return;
+	}
+#endif
+	if (ctx->stage == DDR_PORT_TRAIN_1D) {
+		/* (H) Read the Message Block results */
+		if (phyinit_H_readMsgBlock(port, &ctx->data)) {
+			ddr_port_complete(port, false);
+			return;
+		}
+
+		/* Now optionally perform 2D training for protocols that allow it */
+		if (ctx->data.phy_training_2d) {
+			ctx->stage = DDR_PORT_TRAIN_2D_LOAD;
+			return;
+		}
+	}
+
+#ifdef BAIKAL_DDR_CACHE
+	ddr_trained_ports |= 1 << port;
+#endif
+	ddr_port_complete(port, true);
+}
+
+static bool ddr_port_busy(int port)
+{
+	return ddr_ports[port].stage == DDR_PORT_DEVINIT ||
+	       ddr_ports[port].stage == DDR_PORT_TRAIN_1D ||
+	       ddr_ports[port].stage == DDR_PORT_TRAIN_2D_LOAD ||
+	       ddr_ports[port].stage == DDR_PORT_TRAIN_2D ||
+	       ddr_ports[port].stage == DDR_PORT_ECC_INIT;
+}
+
+/* Process the PMU messages and the ECC init of the running ports */
+static void ddr_ports_service(void)
+{
+	for (int port = 0; port < DDR_PORT_NUM; ++port) {
+		if (ddr_port_busy(port) &&
+		    ddr_ports[port].stage != DDR_PORT_TRAIN_2D_LOAD) {
+			ddr_port_service(port);
+		}
+	}
+}
+
+/*
+ * Service the ports round-robin and start the pending 2D trainings,
+ * return the number of ports not ready yet.
+ */
+static int ddr_ports_poll(void)
+{
+	int busy = 0;
+
+	ddr_ports_service();
+	for (int port = 0; port < DDR_PORT_NUM; ++port) {
+		if (ddr_ports[port].stage == DDR_PORT_TRAIN_2D_LOAD &&
+		    ddr_port_train(port, true)) {
+			ERROR("DDR port #%d: failed to load 2D training fw\n", port);
+			ddr_ports[port].stage = DDR_PORT_FAILED;
+		}
+		if (ddr_port_busy(port)) {
+			++busy;
+		}
+	}
+
+	return busy;
+}
+
+static int ddr_port_start(int port)
+{
+	baikal_boot_ts(BAIKAL_TS_DDR_PORT_START + port);
+#ifdef BAIKAL_DDR_CACHE
+	/* the fw buffer is reused for the cache after all ports are started */
+	if (ddr_cache_used) {
+		return ddr_port_devinit(port);
+	}
+#endif
+	if (ddr_port_train(port, false)) {
+		return -1;
+	}
+
+	/* service the ports started earlier */
+	ddr_ports_poll();
+	return 0;
 }
 
 int dram_init(void)
@@ -221,10 +611,16 @@ int dram_init(void)
 	int conf = 0;
 	int channels = 0;
 	struct ddr4_spd_eeprom *spd_content;
+#ifdef BAIKAL_DDR_CACHE
+	bool ddr_cache_2d = false;
+#endif
 
+	baikal_boot_ts(BAIKAL_TS_DDR_INIT_START);
+	baikal_boot_ts(BAIKAL_TS_SPD_READ_START);
 	baikal_dimm_spd_read();
+	baikal_boot_ts(BAIKAL_TS_SPD_READ_END);
 
-	for (int dimm_idx = 0; dimm_idx < 6; ++dimm_idx) {
+	for (int dimm_idx = 0; dimm_idx < DDR_PORT_NUM; ++dimm_idx) {
 		spd_content = (struct ddr4_spd_eeprom *)baikal_dimm_spd_get(dimm_idx * 2);
 		if (spd_content->mem_type == SPD_MEMTYPE_DDR4) {
 			INFO("DIMM%d: DDR4 SDRAM is detected\n", dimm_idx);
@@ -240,18 +636,108 @@ int dram_init(void)
 
 	bootflash_init();
 
-	for (int dimm_idx = 0; dimm_idx < 6; ++dimm_idx) {
+	for (int dimm_idx = 0; dimm_idx < DDR_PORT_NUM; ++dimm_idx) {
 		if (conf & (1 << (dimm_idx * 2))) {
 			int dual_channel_mode = (conf & (1 << (dimm_idx * 2 + 1))) ? 1 : 0;
 
 			spd_content = (struct ddr4_spd_eeprom *)baikal_dimm_spd_get(dimm_idx * 2);
-			ret = ddr_port_init(dimm_idx, spd_content, channels, dual_channel_mode);
+			ret = ddr_port_prepare(dimm_idx, spd_content, channels,
+					       dual_channel_mode, &ddr_ports[dimm_idx].data);
 			if (ret) {
+				ERROR("Failed to init DDR port #%d\n", dimm_idx);
+				goto error;
+			}
+#ifdef BAIKAL_DDR_CACHE
+			ddr_cache_ports |= 1 << dimm_idx;
+			ddr_cache_key = crc32(spd_content, DDR_CACHE_SPD_SIZE, ddr_cache_key);
+			if (dual_channel_mode) {
+				ddr_cache_key = crc32(baikal_dimm_spd_get(dimm_idx * 2 + 1),
+						      DDR_CACHE_SPD_SIZE, ddr_cache_key);
+			}
+			ddr_cache_key = ddr_cache_key_add(&ddr_ports[dimm_idx].data,
+							  ddr_cache_key);
+			if (ddr_ports[dimm_idx].data.phy_training_2d) {
+				ddr_cache_2d = true;
+			}
+#endif
+		}
+	}
+
+#ifdef BAIKAL_DDR_CACHE
+	/*
+	 * DevInit programs MR6 with the default DRAM VrefDQ, not with the
+	 * value found by 2D training, and the cache holds only the PHY side
+	 * results: configurations trained in 2D are neither cached nor
+	 * restored.
+	 */
+	if (ddr_cache_2d) {
+		ddr_cache_ports = 0;
+	}
+
+	ddr_cache_used = ddr_cache_ports && ddr_cache_lookup();
+	if (ddr_cache_used) {
+		INFO("DDR training results are restored from cache\n");
+	}
+#endif
+
+	/*
+	 * Start PHY training on every populated port, then service the PMU
+	 * mailboxes and the ECC scrubbers of all ports until they are ready.
+	 */
+	for (int dimm_idx = 0; dimm_idx < DDR_PORT_NUM; ++dimm_idx) {
+		if (conf & (1 << (dimm_idx * 2))) {
+			if (ddr_port_start(dimm_idx)) {
+				ERROR("Failed to init DDR port #%d\n", dimm_idx);
+				goto error;
+			}
+		}
+	}
+
+#ifdef BAIKAL_DDR_CACHE
+	if (ddr_cache_used) {
+		ddr_cache_used = ddr_cache_load();
+	}
+#endif
+	while (ddr_ports_poll())
+		;
+
+	/*
+	 * The PHY of a port to retrain has only run DevInit: the controller is
+	 * still waiting in the state left by ctrl_prepare_phy_init(), since
+	 * DFI init is not started until ddr_port_complete(). Full training
+	 * redoes the PHY configuration (step C) and its SequenceCtrl includes
+	 * DevInit, so the DRAM is reset and initialized again before training.
+	 */
+	for (int dimm_idx = 0; dimm_idx < DDR_PORT_NUM; ++dimm_idx) {
+		if (ddr_ports[dimm_idx].stage == DDR_PORT_RETRAIN) {
+			if (ddr_port_train(dimm_idx, false)) {
+				ERROR("Failed to init DDR port #%d\n", dimm_idx);
 				goto error;
 			}
 		}
 	}
 
+	while (ddr_ports_poll())
+		;
+
+	for (int dimm_idx = 0; dimm_idx < DDR_PORT_NUM; ++dimm_idx) {
+		if (ddr_ports[dimm_idx].stage == DDR_PORT_FAILED) {
+			goto error;
+		}
+	}
+
+	for (int dimm_idx = 0; dimm_idx < DDR_PORT_NUM; ++dimm_idx) {
+		struct ddr_configuration *data = &ddr_ports[dimm_idx].data;
+
+		if (ddr_ports[dimm_idx].stage != DDR_PORT_READY) {
+			continue;
+		}
+
+		INFO("DIMM%u: module rate %u MHz, AA-RCD-RP-RAS %u-%u-%u-%u\n", dimm_idx,
+		     data->clock_mhz * 2, data->CL, data->tRCD, data->tRP, data->tRAS);
+	}
+
+	baikal_boot_ts(BAIKAL_TS_DDR_INIT_END);
 	return 0;
 error:
 	ERROR("DDR init failed\n");
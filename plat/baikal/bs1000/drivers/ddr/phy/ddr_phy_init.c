@@ -12,7 +12,6 @@
 #include "ddr_phy_misc.h"
 #include "ddr_phy_tmp_regs.h"
 
-#define NUMBER_ANIB	12
 /*
  * Enable Write DQS Extension feature of PHY.
  * See "DesignWare Cores LPDDR4 MultiPHY, WDQS Extension Application Note"
@@ -579,10 +578,11 @@ void phyinit_E_setDfiClk(int port)
  * register to 4'b0000.
  * -# Wait for the training firmware to complete by following the procedure in
  * "uCtrl Initialization and Mailbox Messaging" implemented in
- * dwc_ddrphy_phyinit_userCustom_G_waitFwDone() function.
- * -# Halt the microcontroller.
+ * phyinit_G_PollFW() function. The mailbox is polled by the caller, so that
+ * several ports can be trained at the same time.
+ * -# Halt the microcontroller with phyinit_G_HaltFW().
  */
-int phyinit_G_ExecFW(int port)
+void phyinit_G_StartFW(int port)
 {
 	/* 1. Reset the firmware microcontroller by writing the MicroReset CSR to set the StallToMicro and */
 	/* ResetToMicro fields to 1 (all other fields should be zero). */
@@ -595,13 +595,13 @@ int phyinit_G_ExecFW(int port)
 	DDRPHY_WRITE_REG16(port, (tAPBONLY | csr_MicroReset_ADDR), 0x0);
 
 	/*
-	 * 3. Wait for the training firmware to complete by following the procedure in
-	 * uCtrl Initialization and Mailbox Messaging"
+	 * 3. The completion of the training firmware is tracked by the caller
+	 * with phyinit_G_PollFW() ("uCtrl Initialization and Mailbox Messaging").
 	 */
-	int ret = phyinit_G_WaitFWDone(port);
+}
 
+void phyinit_G_HaltFW(int port)
+{
 	/* 4. Halt the microcontroller." */
 	DDRPHY_WRITE_REG16(port, (tAPBONLY | csr_MicroReset_ADDR), csr_StallToMicro_MASK);
-
-	return ret;
 }
@@ -4,9 +4,15 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <string.h>
+
 #include <common/debug.h>
 #include <drivers/delay_timer.h>
 #include <lib/mmio.h>
+#include <lib/utils_def.h>
+#ifdef BAIKAL_DDR_FW_COMPRESSED
+#include <zlib.h>
+#endif
 
 #include "../ddr_main.h"
 #include "ddr_phy_tmp_regs.h"
@@ -25,59 +31,157 @@
 void phyinit_LoadPieProdCode_udimm(int port);
 void phyinit_LoadPieProdCode_rdimm(int port);
 
-extern uint8_t firmware_container[];
+extern uint8_t firmware_container[DDR_FW_CONTAINER_SIZE];
+
+static const struct {
+	unsigned int offs;
+	unsigned int size;
+} phyinit_images[2][DDR_FW_IMAGE_NUM] = {
+	{
+		{ UDIMM_PMUTRAIN_1D_IMEM_OFFS, UDIMM_PMUTRAIN_1D_IMEM_SIZE },
+		{ UDIMM_PMUTRAIN_1D_DMEM_OFFS, UDIMM_PMUTRAIN_1D_DMEM_SIZE },
+		{ UDIMM_PMUTRAIN_2D_IMEM_OFFS, UDIMM_PMUTRAIN_2D_IMEM_SIZE },
+		{ UDIMM_PMUTRAIN_2D_DMEM_OFFS, UDIMM_PMUTRAIN_2D_DMEM_SIZE }
+	}, {
+		{ RDIMM_PMUTRAIN_1D_IMEM_OFFS, RDIMM_PMUTRAIN_1D_IMEM_SIZE },
+		{ RDIMM_PMUTRAIN_1D_DMEM_OFFS, RDIMM_PMUTRAIN_1D_DMEM_SIZE },
+		{ RDIMM_PMUTRAIN_2D_IMEM_OFFS, RDIMM_PMUTRAIN_2D_IMEM_SIZE },
+		{ RDIMM_PMUTRAIN_2D_DMEM_OFFS, RDIMM_PMUTRAIN_2D_DMEM_SIZE }
+	}
+};
+
+#ifdef BAIKAL_DDR_FW_COMPRESSED
+static uintptr_t phyinit_zalloc_current;
 
-void phyinit_D_LoadIMEM(int port, struct ddr_configuration *data, int training_2d)
+static voidpf phyinit_zalloc(voidpf opaque, uInt items, uInt size)
 {
-	/* Set MemResetL to avoid glitch on BP_MemReset_L during training */
-	if (!training_2d) {
-		DDRPHY_WRITE_REG16(port, (tMASTER | csr_MemResetL_ADDR), csr_ProtectMemReset_MASK);
+	const uintptr_t end = (uintptr_t)firmware_container + DDR_FW_CONTAINER_SIZE;
+	uintptr_t p = round_up(phyinit_zalloc_current, sizeof(void *));
+
+	size *= items;
+	if (p + size > end) {
+		return NULL;
 	}
 
-	/* select PMU iccm image */
-	unsigned int image_offs = 0;
-	unsigned int image_size = 0;
+	memset((void *)p, 0, size);
+	phyinit_zalloc_current = p + size;
+	return (voidpf)p;
+}
 
-	if (data->registered_dimm) {
-		if (training_2d) {
-			image_offs = RDIMM_PMUTRAIN_2D_IMEM_OFFS;
-			image_size = RDIMM_PMUTRAIN_2D_IMEM_SIZE;
-		} else {
-			image_offs = RDIMM_PMUTRAIN_1D_IMEM_OFFS;
-			image_size = RDIMM_PMUTRAIN_1D_IMEM_SIZE;
+static void phyinit_zfree(voidpf opaque, voidpf ptr)
+{
+}
+
+/*
+ * Inflate the image straight into PHY SRAM. Words before 'first'
+ * are decompressed but not written. Return 0 on success.
+ */
+static int phyinit_InflateImage(int port, uint32_t addr, unsigned int image,
+				 unsigned int first, unsigned int size)
+{
+	const struct ddr_fw_zhdr *const hdr = (struct ddr_fw_zhdr *)firmware_container;
+	uint16_t chunk[256];
+	unsigned int index = 0;
+	z_stream strm;
+	int ret;
+
+	memset(&strm, 0, sizeof(strm));
+	strm.next_in = firmware_container + hdr->image[image].offs;
+	strm.avail_in = hdr->image[image].size;
+	strm.zalloc = phyinit_zalloc;
+	strm.zfree = phyinit_zfree;
+	phyinit_zalloc_current = (uintptr_t)firmware_container + DDR_FW_Z_MAX_SIZE;
+
+	ret = inflateInit2(&strm, DDR_FW_Z_WBITS);
+	while (ret == Z_OK) {
+		unsigned int words;
+
+		strm.next_out = (Bytef *)chunk;
+		strm.avail_out = sizeof(chunk);
+		ret = inflate(&strm, Z_NO_FLUSH);
+		if (ret != Z_OK && ret != Z_STREAM_END) {
+			break;
 		}
-	} else {
-		if (training_2d) {
-			image_offs = UDIMM_PMUTRAIN_2D_IMEM_OFFS;
-			image_size = UDIMM_PMUTRAIN_2D_IMEM_SIZE;
-		} else {
-			image_offs = UDIMM_PMUTRAIN_1D_IMEM_OFFS;
-			image_size = UDIMM_PMUTRAIN_1D_IMEM_SIZE;
+
+		words = (sizeof(chunk) - strm.avail_out) / sizeof(uint16_t);
+		if (index + words > size / sizeof(uint16_t)) {
+			ret = Z_DATA_ERROR;
+			break;
+		}
+
+		for (unsigned int i = 0; i < words; i++, index++) {
+			if (index >= first) {
+				DDRPHY_WRITE_REG16(port, (addr + index), chunk[i]);
+			}
 		}
 	}
 
+	if (ret != Z_STREAM_END || strm.total_out != size) {
+		ERROR("DDR: training fw image %u is corrupted (%d)\n", image, ret);
+		return -1;
+	}
+
+	return 0;
+}
+#endif
+
+/*
+ * Write the training fw image to PHY SRAM, starting from word 'first'.
+ * Only the image itself is written: the memory the fw doesn't use
+ * is left as is, except for the padding to a 32-bit boundary.
+ */
+static int phyinit_WriteImage(int port, uint32_t addr,
+			       struct ddr_configuration *data,
+			       unsigned int image, unsigned int first)
+{
+	const unsigned int size = phyinit_images[data->registered_dimm ? 1 : 0][image].size;
+	unsigned int index = size / sizeof(uint16_t);
+
+#ifdef BAIKAL_DDR_FW_COMPRESSED
+	if (phyinit_InflateImage(port, addr, image, first, size)) {
+		return -1;
+	}
+#else
+	const unsigned int offs = phyinit_images[data->registered_dimm ? 1 : 0][image].offs;
+	const uint16_t *msg = (uint16_t *)(firmware_container + offs);
+
+	for (unsigned int i = first; i < index; i++) {
+		DDRPHY_WRITE_REG16(port, (addr + i), msg[i]);
+	}
+#endif
+	if (index % 2) {
+		/* Always write an even number of words so no 32bit quantity is uninitialized */
+		DDRPHY_WRITE_REG16(port, (addr + index), 0x0);
+	}
+
+	return 0;
+}
+
+int phyinit_D_LoadIMEM(int port, struct ddr_configuration *data, int training_2d)
+{
+	int ret;
+
+	/* Set MemResetL to avoid glitch on BP_MemReset_L during training */
+	if (!training_2d) {
+		DDRPHY_WRITE_REG16(port, (tMASTER | csr_MemResetL_ADDR), csr_ProtectMemReset_MASK);
+	}
+
 	/*
 	 * 1. Enable access to the internal CSRs by setting the MicroContMuxSel CSR to 0.
 	 * This allows the memory controller unrestricted access to the configuration CSRs.
 	 */
 	DDRPHY_WRITE_REG16(port, (tAPBONLY | csr_MicroContMuxSel_ADDR), 0x0);
 
-	const uint16_t *msg = (uint16_t *)(firmware_container + image_offs);
-	unsigned int index;
-
-	for (index = 0; index < image_size / sizeof(uint16_t); index++) {
-		DDRPHY_WRITE_REG16(port, (DDRPHY_PMU_ICCM_ADDR + index), msg[index]);
-	}
-
-	for (; index < DDRPHY_PMU_ICCM_SIZE / sizeof(uint16_t); index++) {
-		DDRPHY_WRITE_REG16(port, (DDRPHY_PMU_ICCM_ADDR + index), 0x0);
-	}
+	/* upload PMU iccm image */
+	ret = phyinit_WriteImage(port, DDRPHY_PMU_ICCM_ADDR, data,
+				 training_2d ? DDR_FW_2D_IMEM : DDR_FW_1D_IMEM, 0);
 
 	/*
 	 * 2. Isolate the APB access from the internal CSRs by setting the MicroContMuxSel CSR to 1.
 	 * This allows the firmware unrestricted access to the configuration CSRs.
 	 */
 	DDRPHY_WRITE_REG16(port, (tAPBONLY | csr_MicroContMuxSel_ADDR), 0x1);
+	return ret;
 }
 
 /** @brief This function loads the training firmware DMEM image and write the
@@ -87,8 +191,10 @@ void phyinit_D_LoadIMEM(int port, struct ddr_configuration *data, int training_2
  * DMEM incv file provided in the training firmware package.
  * -# Write the Firmware Message Block with the required contents detailing the training parameters.
  */
-void phyinit_F_LoadDMEM(int port, struct ddr_configuration *data, const void *mb, int training_2d)
+int phyinit_F_LoadDMEM(int port, struct ddr_configuration *data, const void *mb, int training_2d)
 {
+	int ret;
+
 	/* 1. Enable access to the internal CSRs by setting the MicroContMuxSel CSR to 0. */
 	/*	This allows the memory controller unrestricted access to the configuration CSRs. */
 	DDRPHY_WRITE_REG16(port, (tAPBONLY | csr_MicroContMuxSel_ADDR), 0x0);
@@ -104,43 +210,15 @@ void phyinit_F_LoadDMEM(int port, struct ddr_configuration *data, const void *mb
 	}
 
 	/* upload PMU dccm image (tail without message block) */
-	unsigned int dccm_image_offs = 0;
-	unsigned int dccm_image_size = 0;
-
-	if (data->registered_dimm) {
-		if (training_2d) {
-			dccm_image_offs = RDIMM_PMUTRAIN_2D_DMEM_OFFS;
-			dccm_image_size = RDIMM_PMUTRAIN_2D_DMEM_SIZE;
-		} else {
-			dccm_image_offs = RDIMM_PMUTRAIN_1D_DMEM_OFFS;
-			dccm_image_size = RDIMM_PMUTRAIN_1D_DMEM_SIZE;
-		}
-	} else {
-		if (training_2d) {
-			dccm_image_offs = UDIMM_PMUTRAIN_2D_DMEM_OFFS;
-			dccm_image_size = UDIMM_PMUTRAIN_2D_DMEM_SIZE;
-		} else {
-			dccm_image_offs = UDIMM_PMUTRAIN_1D_DMEM_OFFS;
-			dccm_image_size = UDIMM_PMUTRAIN_1D_DMEM_SIZE;
-		}
-	}
-
-	msg = (uint16_t *)(firmware_container + dccm_image_offs);
-	for (; dccm_index < dccm_image_size / sizeof(uint16_t); dccm_index++) {
-		DDRPHY_WRITE_REG16(port, (DDRPHY_PMU_DCCM_ADDR + dccm_index), msg[dccm_index]);
-	}
-
-	if (dccm_index % 2) {
-		/* Always write an even number of words so no 32bit quantity is uninitialized */
-		DDRPHY_WRITE_REG16(port, (DDRPHY_PMU_DCCM_ADDR + dccm_index), 0x0);
-		dccm_index++;
-	}
+	ret = phyinit_WriteImage(port, DDRPHY_PMU_DCCM_ADDR, data,
+				 training_2d ? DDR_FW_2D_DMEM : DDR_FW_1D_DMEM, dccm_index);
 
 	/*
 	 * 2. Isolate the APB access from the internal CSRs by setting the MicroContMuxSel CSR to 1.
 	 *	This allows the firmware unrestricted access to the configuration CSRs.
 	 */
 	DDRPHY_WRITE_REG16(port, (tAPBONLY | csr_MicroContMuxSel_ADDR), 0x1);
+	return ret;
 }
 
 /**@brief Loads registers after training
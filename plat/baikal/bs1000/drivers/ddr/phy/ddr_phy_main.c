@@ -12,53 +12,33 @@
 #include "ddr_phy_main.h"
 #include "ddr_phy_train_struct.h"
 
-#define PHYINIT_SEQUENCENUM	0
+#define DDRPHY_DEVINIT_MASK	0x1
 
 static struct pmu_smb_ddr4_t msg_block;
 
-int phy_main(int port, struct ddr_configuration *data)
+/*
+ * Run all 1D power states, then 2D P0, to reduce total Imem/Dmem loads
+ * (the default sequence of the "Alternative PHY Training sequence" document).
+ * The training firmware is only started here: its completion is tracked by
+ * the caller with phyinit_G_PollFW(), followed by phyinit_G_HaltFW().
+ * Return -1 if the firmware images could not be loaded.
+ */
+static int phy_fw_start(int port, struct ddr_configuration *data,
+			 int training_2d, bool devinit)
 {
-	int ret = 0;
-
-	/* (C) Initialize PHY Configuration */
-	phyinit_C_PhyConfig(port, data);
-
-	/*
-	 * Switches between supported phyinit training sequences refer to
-	 * "Alternative PHY Training sequence" document for further details.
-	 */
-
-	/* 0x0 | Minimizes number of Imem/Dmem loads (default) */
-	/* 0x1 | High frequency P1/P2/P3 support (DDR4/LP4 only) */
-#if (PHYINIT_SEQUENCENUM == 0)
-	/* Run all 1D power states, then 2D P0, to reduce total Imem/Dmem loads. */
-	/* (D) Load the IMEM Memory for 1D training */
-	phyinit_D_LoadIMEM(port, data, false);
+	if (!training_2d) {
+		/* (C) Initialize PHY Configuration */
+		phyinit_C_PhyConfig(port, data);
 
-	/* (E) Set the PHY input clocks to the desired frequency */
-	phyinit_E_setDfiClk(port);
-	/* Note: this routine implies other items such as DfiFreqRatio, DfiCtlClk are also set properly. */
-
-	/* (F) Write the Message Block parameters for the training firmware */
-	phyinit_calcMb((void *)&msg_block, data, false);
-
-	phyinit_F_LoadDMEM(port, data, &msg_block, false);
-
-	/* (G) Execute the Training Firmware */
-	ret = phyinit_G_ExecFW(port);
-	if (ret) {
-		goto exit;
-	}
-
-	/* WARNING: this is time critical section for RDIMM (avoid any delay from PHY training complete to dfi_init_start) */
-	/* (H) Read the Message Block results */
-	ret = phyinit_H_readMsgBlock(port, data);
-	if (ret) {
-		goto exit;
-	}
+		/* (D) Load the IMEM Memory for 1D training */
+		if (phyinit_D_LoadIMEM(port, data, false)) {
+			return -1;
+		}
 
-	/* Now optionally perform 2D training for protocols that allow it */
-	if (data->phy_training_2d) {
+		/* (E) Set the PHY input clocks to the desired frequency */
+		phyinit_E_setDfiClk(port);
+		/* Note: this routine implies other items such as DfiFreqRatio, DfiCtlClk are also set properly. */
+	} else {
 		/* Step names here mimic the 1D lettering (E,F,G,H). */
 		/* They can be found in the Training Firmware Application Note */
 
@@ -66,78 +46,39 @@ int phy_main(int port, struct ddr_configuration *data)
 		phyinit_E_setDfiClk(port); /* pstate==0; DfiClk fixed 2:1 ratio with MemClk */
 
 		/* 2D-F */
-		phyinit_D_LoadIMEM(port, data, true); /* 2D image */
-
-		/* 2D-F, cont.  Write the Message Block parameters for the training firmware */
-		phyinit_calcMb((void *)&msg_block, data, true); /* pstate=0 */
-
-		phyinit_F_LoadDMEM(port, data, &msg_block, true);
-
-		/* 2D-G Execute the Training Firmware */
-		ret = phyinit_G_ExecFW(port);
-		if (ret) {
-			goto exit;
+		if (phyinit_D_LoadIMEM(port, data, true)) { /* 2D image */
+			return -1;
 		}
-		/* WARNING: this is time critical section for RDIMM (avoid any delay from PHY training complete to dfi_init_start) */
 	}
 
-#else
-
-	/* Run 2D P0  after 1D P0 so 1D P1/P2/P3 can be run at the vrefDAC0 settings trained by 2D. See Share2DVrefResult messageblock field. */
-	/* (D) Load the IMEM Memory for P0 1D training */
-	phyinit_D_LoadIMEM(port, config, false);
-
-	/* (E) Set the PHY input clocks to the desired frequency */
-	phyinit_E_setDfiClk(port);
-	/* Note: this routine implies other items such as DfiFreqRatio, DfiCtlClk are also set properly. */
-
 	/* (F) Write the Message Block parameters for the training firmware */
-	struct pmu_smb_ddr4_t msg_block = {0};
-
-	phyinit_calcMb((void *)&msg_block, data, false);
-
-	phyinit_F_LoadDMEM(port, data, &msg_block, false);
-
-	/* (G) Execute the Training Firmware */
-	ret = phyinit_G_ExecFW(port);
-	if (ret) {
-		goto exit;
+	phyinit_calcMb((void *)&msg_block, data, training_2d);
+	if (devinit) {
+		/* initialize DRAM only, the training results are restored from cache */
+		msg_block.SequenceCtrl = DDRPHY_DEVINIT_MASK;
 	}
 
-	/* (H) Read the Message Block results */
-	ret = phyinit_H_readMsgBlock(port, data);
-	if (ret) {
-		goto exit;
+	if (phyinit_F_LoadDMEM(port, data, &msg_block, training_2d)) {
+		return -1;
 	}
 
-	/* Now optionally perform P0 2D training for protocols that allow it */
-	if (data->phy_training_2d) {
-		/* Step names here mimic the 1D lettering (E,F,G,H). */
-		/* They can be found in the Training Firmware Application Note */
-
-		/* 2D-E Set the PHY input clocks to the highest frequency */
-		phyinit_E_setDfiClk(port); /* pstate==0; DfiClk fixed 2:1 ratio with MemClk */
-
-		/* 2D-F */
-		phyinit_D_LoadIMEM(port, data, true); /* 2D image */
-
-		/* 2D-F, cont.  Write the Message Block parameters for the training firmware */
-		msg_block = {0};
-		phyinit_calcMb((void *)&msg_block, data, true); /* pstate=0 */
-
-		phyinit_F_LoadDMEM(port, data, &msg_block, true);
+	/* (G) Execute the Training Firmware */
+	phyinit_G_StartFW(port);
+	return 0;
+}
 
-		/* 2D-G Execute the Training Firmware */
-		ret = phyinit_G_ExecFW(port);
-		if (ret) {
-			goto exit;
-		}
+int phy_train_start(int port, struct ddr_configuration *data, int training_2d)
+{
+	return phy_fw_start(port, data, training_2d, false);
+}
 
-		/* (D) Reload the IMEM Memory for P1,P2,and P3 1D */
-		phyinit_D_LoadIMEM(port, data, false);
-	}
-#endif
+int phy_devinit_start(int port, struct ddr_configuration *data)
+{
+	return phy_fw_start(port, data, false, true);
+}
 
+void phy_train_finish(int port, struct ddr_configuration *data)
+{
 	/* WARNING: this is time critical section for RDIMM (avoid any delay from PHY training complete to dfi_init_start) */
 
 	/* (I) Load PHY Init Engine Image */
@@ -150,8 +91,4 @@ int phy_main(int port, struct ddr_configuration *data)
 	 * Note: we don't touch DFIPHYUPD register now and assume DFI PHY Update request mode
 	 * to be switch on by default (timeout 64K clocks by default)
 	 */
-
- exit:
-	/* WARNING: this is time critical section for RDIMM (avoid any delay from PHY training complete to dfi_init_start) */
-	return ret;
 }
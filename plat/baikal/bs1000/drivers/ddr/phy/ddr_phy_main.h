@@ -9,14 +9,31 @@
 
 #include "../ddr_main.h"
 
-int phy_main(int port, struct ddr_configuration *data);
-int phyinit_G_ExecFW(int port);
+#define DDRPHY_TRAINING_TIMEOUT	3000000
+
+/* phyinit_G_PollFW() return codes */
+#define PHY_FW_PASS	0	/* training has run successfully */
+#define PHY_FW_FAIL	1	/* training has failed */
+#define PHY_FW_BUSY	2	/* message processed, training is in progress */
+#define PHY_FW_IDLE	3	/* no message from pmu */
+
+/* number of the trained CSRs saved by phyinit_SaveRetRegs() */
+#define DDRPHY_RET_REGS_NUM	1120
+
+int phy_train_start(int port, struct ddr_configuration *data, int training_2d);
+int phy_devinit_start(int port, struct ddr_configuration *data);
+void phy_train_finish(int port, struct ddr_configuration *data);
+void phyinit_G_StartFW(int port);
+int phyinit_G_PollFW(int port);
+void phyinit_G_HaltFW(int port);
 void phyinit_C_PhyConfig(int port, struct ddr_configuration *data);
 void phyinit_E_setDfiClk(int port);
 void phyinit_calcMb(void *mb, struct ddr_configuration *data, int training_2d);
-void phyinit_D_LoadIMEM(int port, struct ddr_configuration *data, int training_2d);
-void phyinit_F_LoadDMEM(int port, struct ddr_configuration *data, const void *mb, int training_2d);
+int phyinit_D_LoadIMEM(int port, struct ddr_configuration *data, int training_2d);
+int phyinit_F_LoadDMEM(int port, struct ddr_configuration *data, const void *mb, int training_2d);
 void phyinit_I_LoadPIE(int port, struct ddr_configuration *data);
 int phyinit_H_readMsgBlock(int port, struct ddr_configuration *data);
+void phyinit_SaveRetRegs(int port, uint16_t *regs);
+void phyinit_RestoreRetRegs(int port, const uint16_t *regs);
 
 #endif /* DDR_PHY_MAIN_H */
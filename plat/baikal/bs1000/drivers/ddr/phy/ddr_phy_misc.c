@@ -4,16 +4,18 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <assert.h>
+
 #include <common/debug.h>
 #include <drivers/delay_timer.h>
 #include <lib/mmio.h>
 
 #include "../ddr_main.h"
+#include "ddr_phy_main.h"
 #include "ddr_phy_misc.h"
 #include "ddr_phy_tmp_regs.h"
 
 #define DDRPHY_MAIL_TIMEOUT	50
-#define DDRPHY_TRAINING_TIMEOUT	3000000
 
 #define ENABLE_HIGHCLKSKEWFIX	0
 #define DDRPHY_MAIL_STRARG_MAX	32
@@ -150,34 +152,111 @@ void print_pmu_major_message(uint16_t major)
 	}
 }
 
-int phyinit_G_WaitFWDone(int port)
+int phyinit_G_PollFW(int port)
 {
-	uint16_t major = -1;
+	uint16_t major;
 
-	do {
-		/* process pmu mailbox */
-		if (get_mail_u16(port, &major, DDRPHY_TRAINING_TIMEOUT)) {
-			/* can't get new message from pmu */
-			ERROR("pmu timeout\n");
-			return 1;
+	/* process a single pmu message, if any, and return */
+	if (get_mail_u16(port, &major, 0)) {
+		return PHY_FW_IDLE;
+	}
+
+	if (major == PMU_MSG_SREAM) {
+		/* special steaming message process */
+		uint32_t str_index;
+		uint32_t str_arg[DDRPHY_MAIL_STRARG_MAX];
+		int argc = get_pmu_streaming_message(port, &str_index, str_arg);
+
+		if (argc >= 0) {
+			print_pmu_streaming_message(str_index, str_arg, argc);
+		} else {
+			ERROR("can't get pmu stream\n");
+		}
+	} else {
+		print_pmu_major_message(major);
+	}
+
+	if (major == PMU_MSG_EOFRW_PASS) {
+		return PHY_FW_PASS;
+	} else if (major == PMU_MSG_EOFRW_FAIL) {
+		return PHY_FW_FAIL;
+	}
+
+	return PHY_FW_BUSY;
+}
+
+static uint16_t *phy_ret_reg(int port, uint32_t addr, uint16_t *reg, bool save)
+{
+	if (save) {
+		*reg = DDRPHY_READ_REG16(port, addr);
+	} else {
+		DDRPHY_WRITE_REG16(port, addr, *reg);
+	}
+
+	return reg + 1;
+}
+
+/*
+ * Walk through the CSRs holding the 1D training results (pstate 0): the
+ * delay, PHY Vref and latency CSRs of the PhyInit retention list for DDR4,
+ * not the complete list. It is only valid for configurations trained in 1D.
+ */
+static void phy_ret_regs(int port, uint16_t *regs, bool save)
+{
+	uint16_t *const start = regs;
+
+	/* Enable access to the internal CSRs by setting the MicroContMuxSel CSR to 0. */
+	DDRPHY_WRITE_REG16(port, (tAPBONLY | csr_MicroContMuxSel_ADDR), 0x0);
+
+	for (int anib = 0; anib < NUMBER_ANIB; anib++) {
+		regs = phy_ret_reg(port, (anib * c1 | tANIB | csr_ATxDly_ADDR), regs, save);
+	}
+
+	regs = phy_ret_reg(port, (tMASTER | csr_HwtMRL_ADDR), regs, save);
+
+	for (int d = 0; d < NUMBER_DBYTE; d++) {
+		const uint32_t c_addr = d * c1 | tDBYTE;
+
+		regs = phy_ret_reg(port, (c_addr | csr_DFIMRL_ADDR), regs, save);
+
+		for (int lane = 0; lane < 9; lane++) {
+			const uint32_t r_addr = c_addr | lane * r1;
+
+			regs = phy_ret_reg(port, (r_addr | csr_VrefDAC0_ADDR), regs, save);
+			regs = phy_ret_reg(port, (r_addr | csr_VrefDAC1_ADDR), regs, save);
+			for (int tg = 0; tg < 4; tg++) {
+				regs = phy_ret_reg(port, (r_addr | (csr_TxDqDlyTg0_ADDR + tg)), regs, save);
+				regs = phy_ret_reg(port, (r_addr | (csr_RxPBDlyTg0_ADDR + tg)), regs, save);
+			}
 		}
-		if (major == PMU_MSG_SREAM) {
-			/* special steaming message process */
-			uint32_t str_index;
-			uint32_t str_arg[DDRPHY_MAIL_STRARG_MAX];
-			int argc = get_pmu_streaming_message(port, &str_index, str_arg);
 
-			if (argc >= 0) {
-				print_pmu_streaming_message(str_index, str_arg, argc);
-			} else {
-				ERROR("can't get pmu stream\n");
+		for (int nib = 0; nib < 2; nib++) {
+			const uint32_t b_addr = c_addr | nib * b1;
+
+			for (int tg = 0; tg < 4; tg++) {
+				regs = phy_ret_reg(port, (b_addr | (csr_TxDqsDlyTg0_ADDR + tg)), regs, save);
+				regs = phy_ret_reg(port, (b_addr | (csr_RxEnDlyTg0_ADDR + tg)), regs, save);
+				regs = phy_ret_reg(port, (b_addr | (csr_RxClkDlyTg0_ADDR + tg)), regs, save);
+				regs = phy_ret_reg(port, (b_addr | (csr_RxClkcDlyTg0_ADDR + tg)), regs, save);
 			}
-		} else {
-			print_pmu_major_message(major);
 		}
-	} while ((major != PMU_MSG_EOFRW_PASS) && (major != PMU_MSG_EOFRW_FAIL));
+	}
+
+	/* Isolate the APB access from the internal CSRs by setting the MicroContMuxSel CSR to 1. */
+	DDRPHY_WRITE_REG16(port, (tAPBONLY | csr_MicroContMuxSel_ADDR), 0x1);
+
+	assert(regs - start == DDRPHY_RET_REGS_NUM);
+	(void)start;
+}
 
-	return (major == PMU_MSG_EOFRW_PASS) ? 0 : 1;
+void phyinit_SaveRetRegs(int port, uint16_t *regs)
+{
+	phy_ret_regs(port, regs, true);
+}
+
+void phyinit_RestoreRetRegs(int port, const uint16_t *regs)
+{
+	phy_ret_regs(port, (uint16_t *)regs, false);
 }
 
 void phyinit_LoadPieProdCode_udimm(int port)
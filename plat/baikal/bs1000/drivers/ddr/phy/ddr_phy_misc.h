@@ -7,6 +7,9 @@
 #ifndef DDR_PHY_MISC_H
 #define DDR_PHY_MISC_H
 
+#define NUMBER_ANIB	12
+#define NUMBER_DBYTE	9
+
 #define PHY_EQL_DFE     1
 #define PHY_EQL_FFE     2
 
@@ -42,7 +45,6 @@ struct pmu_msg_info {
 	const char *info;
 };
 
-int phyinit_G_WaitFWDone(int port);
 void phyinit_LoadPieProdCode_udimm(int port);
 void phyinit_LoadPieProdCode_rdimm(int port);
 int phyinit_mapDrvStren(int DrvStren_ohm, enum drv_stren_t TargetCSR);
@@ -28,6 +28,38 @@
 #define UDIMM_PMUTRAIN_2D_DMEM_OFFS	52016
 #define UDIMM_PMUTRAIN_2D_DMEM_SIZE	1452
 
+#define DDR_FW_CONTAINER_SIZE		(RDIMM_PMUTRAIN_2D_DMEM_OFFS + RDIMM_PMUTRAIN_2D_DMEM_SIZE)
+
+/* Images of the training fw container, in the container order */
+enum ddr_fw_image {
+	DDR_FW_1D_IMEM,
+	DDR_FW_1D_DMEM,
+	DDR_FW_2D_IMEM,
+	DDR_FW_2D_DMEM,
+	DDR_FW_IMAGE_NUM
+};
+
+#ifdef BAIKAL_DDR_FW_COMPRESSED
+#define DDR_FW_Z_MAGIC			0x5a574644 /* "DFWZ" */
+#define DDR_FW_Z_WBITS			12
+/* inflate state and window, at the end of the container buffer */
+#define DDR_FW_Z_WORKSPACE		(12 * 1024)
+#define DDR_FW_Z_MAX_SIZE		(DDR_FW_CONTAINER_SIZE - DDR_FW_Z_WORKSPACE)
+
+/*
+ * Compressed training fw container: the header is followed by the images,
+ * each of them is a separate zlib stream to be inflated into PHY SRAM.
+ */
+struct ddr_fw_zhdr {
+	uint32_t magic;
+	uint32_t size;	/* container size including the header */
+	struct {
+		uint32_t offs;	/* from the start of the container */
+		uint32_t size;
+	} image[DDR_FW_IMAGE_NUM];
+};
+#endif
+
 struct pmu_smb_ddr4_t {
 	uint8_t  Reserved00;
 	uint8_t  MsgMisc;
@@ -33,6 +33,7 @@
 #define BAIKAL_BOOT_SPI_BAUDR		16
 #define BAIKAL_BOOT_SPI_SS_LINE		0
 #define BAIKAL_BOOT_SPI_GPIO_BASE	GPIO32_BASE
+#define BAIKAL_BOOT_SPI_MAX_LANES	4
 #define BAIKAL_BOOT_SPI_SUBSECTOR	(4 * 1024)
 #define BAIKAL_BOOT_SPI_SIZE		(32 * 1024 * 1024)
 
@@ -42,6 +43,8 @@
 #if defined(BAIKAL_QEMU)
 # undef  SYS_COUNTER_FREQ_IN_TICKS
 # define SYS_COUNTER_FREQ_IN_TICKS	ULL((1000 * 1000 * 1000) / 16)
+# undef  BAIKAL_BOOT_SPI_MAX_LANES
+# define BAIKAL_BOOT_SPI_MAX_LANES	1
 #endif
 
 #if defined(ELPITECH)
@@ -9,6 +9,40 @@
 
 #include <stdint.h>
 
+/*
+ * A register access sequence executed by scp_lcru_batch(). Each access to
+ * the SCP LCRU is a mailbox round trip, so the batch remembers the last
+ * value of a register it has read or written and skips the reads (and the
+ * unchanged writes) that would only return what is already known. The
+ * remembered value is dropped after a delay, a poll leaves its last read.
+ */
+enum scp_lcru_op_type {
+	SCP_LCRU_OP_READ,	/* val = *addr */
+	SCP_LCRU_OP_WRITE,	/* *addr = val */
+	SCP_LCRU_OP_CLRSET,	/* *addr = (*addr & ~mask) | val */
+	SCP_LCRU_OP_POLL,	/* wait for (*addr & mask) == val, arg tries */
+	SCP_LCRU_OP_DELAY	/* udelay(arg) */
+};
+
+struct scp_lcru_op {
+	uint32_t	type;
+	uint32_t	addr;
+	uint32_t	mask;
+	uint32_t	val;
+	uint32_t	arg;
+};
+
+#define SCP_LCRU_POLL_DELAY_US	10
+
+#define SCP_LCRU_READ(_addr)			{ SCP_LCRU_OP_READ, (_addr), 0, 0, 0 }
+#define SCP_LCRU_WRITE(_addr, _val)		{ SCP_LCRU_OP_WRITE, (_addr), 0, (_val), 0 }
+#define SCP_LCRU_CLRSET(_addr, _clr, _set)	{ SCP_LCRU_OP_CLRSET, (_addr), (_clr), (_set), 0 }
+#define SCP_LCRU_POLL(_addr, _mask, _val, _tries) \
+						{ SCP_LCRU_OP_POLL, (_addr), (_mask), (_val), (_tries) }
+#define SCP_LCRU_DELAY(_us)			{ SCP_LCRU_OP_DELAY, 0, 0, 0, (_us) }
+
+/* Addresses outside of the SCP LCRU are accessed directly */
+int scp_lcru_batch(struct scp_lcru_op *const ops, const unsigned int num);
 int scp_lcru_clrbits(const uint32_t addr, const uint32_t clr);
 int scp_lcru_clrsetbits(const uint32_t addr, const uint32_t clr, const uint32_t set);
 int scp_lcru_read(const uint32_t addr, uint32_t *const val);
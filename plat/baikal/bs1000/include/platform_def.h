@@ -50,10 +50,17 @@
 #define CACHE_WRITEBACK_SHIFT		U(6)
 #define CACHE_WRITEBACK_GRANULE		(U(1) << CACHE_WRITEBACK_SHIFT)
 
+#ifdef IMAGE_BL31
+/* Reserve room for the dynamically mapped flash and PVT shared buffers */
+#define MAX_MMAP_REGIONS		21
+#define MAX_XLAT_TABLES			17
+#else
 #define MAX_MMAP_REGIONS		19
 #define MAX_XLAT_TABLES			11
+#endif
 #define MAX_IO_DEVICES			3
 #define MAX_IO_HANDLES			6
+#define MAX_IO_BLOCK_DEVICES		1
 
 /* Partition memory into secure ROM, non-secure DRAM, secure "SRAM", and secure DRAM */
 #define NS_DRAM0_BASE			0x80000000
@@ -103,6 +110,10 @@
 #define BAIKAL_FIP_BASE			(BAIKAL_SEC_DTB_BASE + BAIKAL_DTB_MAX_SIZE)
 #define BAIKAL_FIP_LIMIT		(BAIKAL_FIP_BASE + BAIKAL_FIP_MAX_SIZE)
 
+/* Boot timeline points shared by BL1, BL2 and BL31, at the top of the DTB area */
+#define BAIKAL_BOOT_TIMELINE_SIZE	0x200
+#define BAIKAL_BOOT_TIMELINE_BASE	(BAIKAL_FIP_BASE - BAIKAL_BOOT_TIMELINE_SIZE)
+
 #define BAIKAL_SEC_DTB_BASE		(BAIKAL_SCMM_SMMU_BASE + BAIKAL_SCMM_SMMU_SIZE)
 #define BAIKAL_NS_DTB_BASE		NS_DRAM0_BASE
 #define BAIKAL_NS_IMAGE_OFFSET		NS_DRAM1_BASE
@@ -113,11 +124,13 @@
 #define BAIKAL_BL1_MAX_SIZE		(256 * 1024)
 #define BAIKAL_DTB_MAX_SIZE		(256 * 1024)
 #define BAIKAL_VAR_MAX_SIZE		(768 * 1024)
+#define BAIKAL_DDR_CACHE_MAX_SIZE	(16 * 1024)
 #define BAIKAL_FIP_MAX_SIZE		(BAIKAL_FAT_OFFSET - BAIKAL_BL1_MAX_SIZE - BAIKAL_DTB_MAX_SIZE - BAIKAL_VAR_MAX_SIZE)
 
 #define BAIKAL_BL1_OFFSET		0
 #define BAIKAL_DTB_OFFSET		(BAIKAL_BL1_OFFSET + BAIKAL_BL1_MAX_SIZE)
 #define BAIKAL_TFW_OFFSET		(BAIKAL_DTB_OFFSET + 128 * 1024)
+#define BAIKAL_DDR_CACHE_OFFSET		(BAIKAL_VAR_OFFSET - BAIKAL_DDR_CACHE_MAX_SIZE)
 #define BAIKAL_VAR_OFFSET		(BAIKAL_DTB_OFFSET + BAIKAL_DTB_MAX_SIZE)
 #define BAIKAL_FIP_OFFSET		(BAIKAL_VAR_OFFSET + BAIKAL_VAR_MAX_SIZE)
 #define BAIKAL_FAT_OFFSET		(8 * 1024 * 1024)
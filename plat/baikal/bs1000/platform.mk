@@ -27,6 +27,30 @@ else
 $(error "Error: unknown BAIKAL_TARGET=${BAIKAL_TARGET}")
 endif
 
+ifneq ($(BAIKAL_CRC_BENCH),)
+$(eval $(call add_define,BAIKAL_CRC_BENCH))
+endif
+
+ifneq ($(BAIKAL_SPI_FLASH_BENCH),)
+$(eval $(call add_define,BAIKAL_SPI_FLASH_BENCH))
+endif
+
+ifneq ($(BAIKAL_BOOT_TIMELINE),)
+$(eval $(call add_define,BAIKAL_BOOT_TIMELINE))
+endif
+
+ifneq ($(BAIKAL_DRAM_ZERO),)
+$(eval $(call add_define,BAIKAL_DRAM_ZERO))
+endif
+
+ifneq ($(BAIKAL_DDR_CACHE),)
+$(eval $(call add_define,BAIKAL_DDR_CACHE))
+endif
+
+ifneq ($(BAIKAL_DDR_FW_COMPRESSED),)
+$(eval $(call add_define,BAIKAL_DDR_FW_COMPRESSED))
+endif
+
 PLAT_INCLUDES		:=	-Iinclude/plat/arm/common/aarch64	\
 				-Iplat/baikal/bs1000/drivers		\
 				-Iplat/baikal/bs1000/drivers/ddr	\
@@ -46,8 +70,8 @@ PLAT_BL_COMMON_SOURCES	:=	drivers/arm/pl011/aarch64/pl011_console.S	\
 
 BL1_SOURCES		+=	drivers/delay_timer/delay_timer.c		\
 				drivers/delay_timer/generic_delay_timer.c	\
+				drivers/io/io_block.c				\
 				drivers/io/io_fip.c				\
-				drivers/io/io_memmap.c				\
 				drivers/io/io_storage.c				\
 				lib/cpus/aarch64/cortex_a75.S			\
 				plat/baikal/bs1000/bs1000_bl1_setup.c		\
@@ -74,11 +98,23 @@ BL1_SOURCES		+=	drivers/delay_timer/delay_timer.c		\
 				plat/baikal/common/memtest.c			\
 				plat/baikal/common/spd.c
 
+ifneq ($(BAIKAL_DDR_FW_COMPRESSED),)
+include lib/zlib/zlib.mk
+BAIKAL_ZLIB_SOURCES	:=	$(filter-out %/tf_gunzip.c,$(ZLIB_SOURCES))
+PLAT_INCLUDES		+=	-I$(ZLIB_PATH)
+BL1_SOURCES		+=	$(BAIKAL_ZLIB_SOURCES)
+# keep zlib crc32() apart from the platform one: only zlib and its user see Z_PREFIX
+$(addprefix $(BUILD_PLAT)/bl1/,$(notdir $(BAIKAL_ZLIB_SOURCES:.c=.o)) ddr_phy_load.o): \
+			TF_CFLAGS += -DZ_PREFIX
+endif
+
 override BL1_DEFAULT_LINKER_SCRIPT_SOURCE := plat/baikal/common/bl1.ld.S
 
 BL2_SOURCES		+=	common/desc_image_load.c			\
+				drivers/delay_timer/delay_timer.c		\
+				drivers/delay_timer/generic_delay_timer.c	\
+				drivers/io/io_block.c				\
 				drivers/io/io_fip.c				\
-				drivers/io/io_memmap.c				\
 				drivers/io/io_storage.c				\
 				plat/baikal/bs1000/bs1000_bl2_setup.c		\
 				plat/baikal/common/baikal_bl2_mem_params_desc.c	\
@@ -124,6 +160,16 @@ ifeq (${ENABLE_PMF}, 1)
 BL31_SOURCES		+=	lib/pmf/pmf_smc.c
 endif
 
+ifneq ($(BAIKAL_BOOT_TIMELINE),)
+BL1_SOURCES		+=	plat/baikal/common/baikal_boot_timeline.c
+BL2_SOURCES		+=	plat/baikal/common/baikal_boot_timeline.c
+BL31_SOURCES		+=	plat/baikal/common/baikal_boot_timeline.c
+endif
+
+ifneq ($(BAIKAL_DRAM_ZERO),)
+BL31_SOURCES		+=	plat/baikal/common/baikal_dram_zero.c
+endif
+
 ifeq ($(notdir $(CC)),armclang)
 TF_CFLAGS_aarch64	+=	-mcpu=cortex-a75
 else ifneq ($(findstring clang,$(notdir $(CC))),)
@@ -136,4 +182,5 @@ BL1_CPPFLAGS += -march=armv8-a+crc
 BL2_CPPFLAGS += -march=armv8-a+crc
 BL2U_CPPFLAGS += -march=armv8-a+crc
 BL31_CPPFLAGS += -march=armv8-a+crc
+BL31_CPPFLAGS += -DPLAT_XLAT_TABLES_DYNAMIC=1
 BL32_CPPFLAGS += -march=armv8-a+crc
@@ -8,6 +8,7 @@
 
 #include <common/bl_common.h>
 
+#include <baikal_boot_timeline.h>
 #include <baikal_console.h>
 #include <baikal_def.h>
 
@@ -21,6 +22,7 @@ void bl31_early_platform_setup2(u_register_t arg0,
 {
 	bl_params_t *params_from_bl2 = (bl_params_t *)arg0;
 
+	baikal_boot_ts(BAIKAL_TS_BL31_START);
 	baikal_console_boot_init();
 
 	assert(arg1 == BAIKAL_BL31_PLAT_PARAM_VAL);
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2023, Baikal Electronics, JSC. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include <arch_helpers.h>
+#include <common/debug.h>
+#include <common/tbbr/tbbr_img_def.h>
+#include <lib/cassert.h>
+#include <lib/pmf/pmf.h>
+
+#include <baikal_boot_timeline.h>
+#include <platform_def.h>
+
+CASSERT(BAIKAL_TS_NUM * sizeof(uint64_t) <= BAIKAL_BOOT_TIMELINE_SIZE,
+	assert_boot_timeline_size);
+CASSERT(BAIKAL_TS_NUM <= (PMF_TID_MASK >> PMF_TID_SHIFT),
+	assert_boot_timeline_tid);
+
+#ifdef IMAGE_BL1
+/* DRAM is not up yet when BL1 starts */
+static uint64_t bl1_timeline[BAIKAL_TS_NUM];
+static uint64_t *timeline = bl1_timeline;
+
+void baikal_boot_ts_handover(void)
+{
+	uint64_t *const buf = (uint64_t *)BAIKAL_BOOT_TIMELINE_BASE;
+
+	memcpy(buf, bl1_timeline, sizeof(bl1_timeline));
+	flush_dcache_range((uintptr_t)buf, sizeof(bl1_timeline));
+	timeline = buf;
+}
+#else
+static uint64_t *const timeline = (uint64_t *)BAIKAL_BOOT_TIMELINE_BASE;
+#endif
+
+/*
+ * The points are written both with the MMU off and on, so every write is
+ * pushed out of the cache at once.
+ */
+void baikal_boot_ts(const unsigned int id)
+{
+	assert(id < BAIKAL_TS_NUM);
+
+	timeline[id] = read_cntpct_el0();
+	flush_dcache_range((uintptr_t)&timeline[id], sizeof(timeline[id]));
+}
+
+#ifdef IMAGE_BL2
+void baikal_boot_ts_image_loaded(const unsigned int image_id)
+{
+	switch (image_id) {
+	case BL31_IMAGE_ID:
+		baikal_boot_ts(BAIKAL_TS_BL31_LOADED);
+		break;
+	case BL32_IMAGE_ID:
+		baikal_boot_ts(BAIKAL_TS_BL32_LOADED);
+		break;
+	case BL33_IMAGE_ID:
+		baikal_boot_ts(BAIKAL_TS_BL33_LOADED);
+		break;
+	default:
+		break;
+	}
+}
+#endif
+
+#ifdef IMAGE_BL31
+static const char *const ts_names[BAIKAL_TS_NUM] = {
+	[BAIKAL_TS_BL1_START]			= "BL1 start",
+	[BAIKAL_TS_SPD_READ_START]		= "SPD read start",
+	[BAIKAL_TS_SPD_READ_END]		= "SPD read end",
+	[BAIKAL_TS_DDR_INIT_START]		= "DDR init start",
+	[BAIKAL_TS_DDR_FW_READ_START]		= "DDR fw read start",
+	[BAIKAL_TS_DDR_FW_READ_END]		= "DDR fw read end",
+	[BAIKAL_TS_DDR_INIT_END]		= "DDR init end",
+	[BAIKAL_TS_MEMTEST_END]			= "memtest end",
+	[BAIKAL_TS_BOOT_DEV_PROBE_START]	= "boot dev probe start",
+	[BAIKAL_TS_BOOT_DEV_PROBE_END]		= "boot dev probe end",
+	[BAIKAL_TS_BL1_SPLASH_START]		= "BL1 splash start",
+	[BAIKAL_TS_BL1_SPLASH_END]		= "BL1 splash end",
+	[BAIKAL_TS_BL2_LOADED]			= "BL2 loaded",
+	[BAIKAL_TS_BL2_START]			= "BL2 start",
+	[BAIKAL_TS_BL31_LOADED]			= "BL31 loaded",
+	[BAIKAL_TS_BL32_LOADED]			= "BL32 loaded",
+	[BAIKAL_TS_BL33_LOADED]			= "BL33 loaded",
+	[BAIKAL_TS_BL31_START]			= "BL31 start",
+	[BAIKAL_TS_PCIE_INIT_START]		= "PCIe init start",
+	[BAIKAL_TS_PCIE_INIT_END]		= "PCIe init end",
+	[BAIKAL_TS_BL31_SPLASH_START]		= "BL31 splash start",
+	[BAIKAL_TS_BL31_SPLASH_END]		= "BL31 splash end",
+	[BAIKAL_TS_BL31_PLATFORM_SETUP_END]	= "BL31 platform setup end",
+	[BAIKAL_TS_DRAM_ZERO_START]		= "DRAM zero start",
+	[BAIKAL_TS_DRAM_ZERO_END]		= "DRAM zero end"
+};
+
+void baikal_boot_ts_print(void)
+{
+	const uint64_t freq = read_cntfrq_el0();
+	unsigned int id;
+
+	for (id = 0; id < BAIKAL_TS_NUM; ++id) {
+		const uint64_t us = timeline[id] * 1000000 / freq;
+
+		if (timeline[id] == 0) {
+			continue;
+		}
+
+		if (id >= BAIKAL_TS_DDR_PORT_START && id < BAIKAL_TS_DDR_INIT_END) {
+			static const char *const phases[] = {"start", "trained", "ready"};
+			const unsigned int n = id - BAIKAL_TS_DDR_PORT_START;
+
+			INFO("boot: %8lu us: DDR port #%u %s\n", us,
+			     n % BAIKAL_TS_DDR_PORTS, phases[n / BAIKAL_TS_DDR_PORTS]);
+		} else {
+			INFO("boot: %8lu us: %s\n", us, ts_names[id]);
+		}
+	}
+}
+
+#if ENABLE_PMF
+static unsigned long long baikal_boot_ts_get(unsigned int tid,
+					     u_register_t mpidr,
+					     unsigned int flags)
+{
+	/* the timeline is not per-CPU, any valid MPIDR selects it */
+	return timeline[tid & PMF_TID_MASK];
+}
+
+PMF_REGISTER_SERVICE_SMC_OWN(baikal_boot, PMF_ARM_TIF_IMPL_ID,
+			     BAIKAL_PMF_BOOT_SVC_ID, BAIKAL_TS_NUM,
+			     NULL, baikal_boot_ts_get)
+#endif
+#endif /* IMAGE_BL31 */
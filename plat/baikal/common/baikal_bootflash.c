@@ -50,3 +50,30 @@ int bootflash_write(uint32_t addr, void *data, size_t size)
 	return spi_flash_write(BAIKAL_BOOT_SPI_SS_LINE, addr, data, size);
 #endif
 }
+
+int bootflash_busy(void)
+{
+#if defined(BAIKAL_SCP_FLASH)
+	return scp_flash_busy();
+#else
+	return spi_flash_busy(BAIKAL_BOOT_SPI_SS_LINE);
+#endif
+}
+
+int bootflash_erase_step(uint32_t addr, size_t size)
+{
+#if defined(BAIKAL_SCP_FLASH)
+	return scp_flash_erase_step(addr, size);
+#else
+	return spi_flash_erase_step(BAIKAL_BOOT_SPI_SS_LINE, addr, size);
+#endif
+}
+
+int bootflash_write_step(uint32_t addr, void *data, size_t size)
+{
+#if defined(BAIKAL_SCP_FLASH)
+	return scp_flash_write_step(addr, data, size);
+#else
+	return spi_flash_write_step(BAIKAL_BOOT_SPI_SS_LINE, addr, data, size);
+#endif
+}
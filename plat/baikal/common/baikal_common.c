@@ -1,14 +1,79 @@
 /*
- * Copyright (c) 2021, Baikal Electronics, JSC. All rights reserved.
+ * Copyright (c) 2021-2023, Baikal Electronics, JSC. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <lib/spinlock.h>
+#include <lib/utils_def.h>
 #include <plat/common/platform.h>
 
 #include <baikal_def.h>
+#include <baikal_sip_svc.h>
+#include <platform_def.h>
+
+#ifdef IMAGE_BL31
+spinlock_t baikal_mmap_lock;
+#endif
 
 unsigned int plat_get_syscnt_freq2(void)
 {
 	return SYS_COUNTER_FREQ_IN_TICKS;
 }
+
+static bool range_inside(const uint64_t base, const uint64_t size,
+			 const uint64_t area_base, const uint64_t area_size)
+{
+	return base >= area_base &&
+	       base - area_base <= area_size &&
+	       size <= area_size - (base - area_base);
+}
+
+static bool range_overlaps(const uint64_t base, const uint64_t size,
+			   const uint64_t area_base, const uint64_t area_size)
+{
+	return base < area_base + area_size && area_base < base + size;
+}
+
+bool baikal_is_ns_dram(const uint64_t base, const uint64_t size)
+{
+	static const uint64_t ns_areas[][2] = {
+		{NS_DRAM0_BASE,	NS_DRAM0_SIZE},
+		{NS_DRAM1_BASE,	NS_DRAM1_SIZE}
+	};
+	static const uint64_t sec_areas[][2] = {
+		{SEC_DRAM_BASE,	SEC_DRAM_SIZE},
+		{BL31_BASE,	BL31_LIMIT - BL31_BASE},
+#ifdef BL32_BASE
+		{BL32_BASE,	BL32_LIMIT - BL32_BASE}
+#endif
+	};
+	bool inside = false;
+	unsigned int i;
+
+	if (size == 0 || base + size < base) {
+		return false;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(ns_areas); ++i) {
+		if (range_inside(base, size, ns_areas[i][0], ns_areas[i][1])) {
+			inside = true;
+			break;
+		}
+	}
+
+	if (!inside) {
+		return false;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(sec_areas); ++i) {
+		if (range_overlaps(base, size, sec_areas[i][0], sec_areas[i][1])) {
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2023, Baikal Electronics, JSC. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdbool.h>
+
+#include <arch_helpers.h>
+#include <common/debug.h>
+#include <lib/utils.h>
+#include <lib/utils_def.h>
+#include <lib/xlat_tables/xlat_tables_v2.h>
+
+#include <baikal_dram_zero.h>
+#include <baikal_sip_svc.h>
+#include <platform_def.h>
+
+/*
+ * The DRAM is zeroed through a temporary flat mapping of up to one 1 GiB
+ * block at a time. The mapping is Normal Non-cacheable: DC ZVA then writes
+ * whole lines straight to the memory instead of allocating them in the
+ * caches and evicting the rest of BL31 data.
+ */
+#define DRAM_ZERO_CHUNK		(UL(1) << 30)
+
+/* Areas already in use when BL31 starts, in no particular order */
+static const uint64_t dram_zero_skip[][2] = {
+	{SEC_DRAM_BASE,			SEC_DRAM_SIZE},
+	{BAIKAL_NS_DTB_BASE,		BAIKAL_DTB_MAX_SIZE},
+	{BAIKAL_NS_IMAGE_OFFSET,	BAIKAL_NS_IMAGE_MAX_SIZE}
+};
+
+static int dram_zero_chunk(const uint64_t base, const uint64_t size)
+{
+	int err;
+
+	spin_lock(&baikal_mmap_lock);
+	err = mmap_add_dynamic_region(base, base, size,
+				      MT_NON_CACHEABLE | MT_RW | MT_NS |
+				      MT_EXECUTE_NEVER);
+	if (err) {
+		ERROR("%s: unable to map 0x%lx-0x%lx, err %d\n", __func__,
+		      base, base + size - 1, err);
+		goto exit;
+	}
+
+	zero_normalmem((void *)base, size);
+
+	err = mmap_remove_dynamic_region(base, size);
+	if (err) {
+		ERROR("%s: unable to unmap 0x%lx, err %d\n", __func__, base, err);
+	}
+
+exit:
+	spin_unlock(&baikal_mmap_lock);
+	return err;
+}
+
+static int dram_zero_range(uint64_t base, const uint64_t end, uint64_t *const zeroed)
+{
+	while (base < end) {
+		uint64_t limit = MIN(end, (base | (DRAM_ZERO_CHUNK - 1)) + 1);
+		bool skip = false;
+		unsigned int i;
+		int err;
+
+		for (i = 0; i < ARRAY_SIZE(dram_zero_skip); ++i) {
+			const uint64_t skip_base = dram_zero_skip[i][0];
+			const uint64_t skip_end = skip_base + dram_zero_skip[i][1];
+
+			if (skip_base <= base && base < skip_end) {
+				/* step over the area to keep */
+				base = skip_end;
+				skip = true;
+				break;
+			} else if (base < skip_base && skip_base < limit) {
+				/* stop right before it */
+				limit = skip_base;
+			}
+		}
+
+		if (skip) {
+			continue;
+		}
+
+		err = dram_zero_chunk(base, limit - base);
+		if (err) {
+			return err;
+		}
+
+		*zeroed += limit - base;
+		base = limit;
+	}
+
+	return 0;
+}
+
+int baikal_dram_zero(const uint64_t region_descs[][2],
+		     const unsigned int region_num)
+{
+	const uint64_t t0 = read_cntpct_el0();
+	uint64_t zeroed = 0;
+	unsigned int region;
+	uint64_t ms;
+	int err;
+
+	for (region = 0; region < region_num; ++region) {
+		const uint64_t base = region_descs[region][0];
+		const uint64_t size = region_descs[region][1];
+
+		if (size == 0) {
+			continue;
+		}
+
+		INFO("%s: 0x%lx-0x%lx\n", __func__, base, base + size - 1);
+		err = dram_zero_range(base, base + size, &zeroed);
+		if (err) {
+			return err;
+		}
+	}
+
+	ms = (read_cntpct_el0() - t0) * 1000 / read_cntfrq_el0();
+	INFO("%s: %lu MiB in %lu ms\n", __func__, zeroed >> 20, ms);
+	return 0;
+}
@@ -6,12 +6,16 @@
 
 #include <common/desc_image_load.h>
 
+#include <baikal_io_storage.h>
+
 /*******************************************************************************
  * This function is a wrapper of a common function which flushes the data
  * structures so that they are visible in memory for the next BL image.
  ******************************************************************************/
 void plat_flush_next_bl_params(void)
 {
+	/* All images are loaded: release the boot device */
+	plat_baikal_io_exit();
 	flush_bl_params_desc();
 }
 
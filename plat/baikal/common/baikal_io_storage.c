@@ -13,13 +13,13 @@
 #include <drivers/io/io_block.h>
 #include <drivers/io/io_driver.h>
 #include <drivers/io/io_fip.h>
-#include <drivers/io/io_memmap.h>
 #include <drivers/io/io_storage.h>
 #include <endian.h>
 #include <lib/utils_def.h>
 #include <libfdt.h>
 #include <tools_share/firmware_image_package.h>
 
+#include <baikal_boot_timeline.h>
 #include <baikal_bootflash.h>
 #include <crc.h>
 #include <platform_def.h>
@@ -31,14 +31,29 @@
 /* IO devices */
 static const io_dev_connector_t *fip_dev_con;
 static uintptr_t fip_dev_handle;
-static const io_dev_connector_t *memmap_dev_con;
-static uintptr_t memmap_dev_handle;
+static const io_dev_connector_t *boot_dev_con;
+static uintptr_t boot_dev_handle;
+#ifdef BAIKAL_SD_FIRMWARE
+static bool boot_dev_is_sd;
+#endif
 
-static const io_block_spec_t fip_block_spec = {
-	.offset = BAIKAL_FIP_BASE,
+/*
+ * The FIP is not copied to DRAM as a whole: io_fip reads the ToC and then
+ * each image on demand straight from the boot device. The FIP area in DRAM
+ * only serves as the bounce buffer of the block driver.
+ */
+static io_block_spec_t fip_block_spec = {
 	.length = BAIKAL_FIP_MAX_SIZE
 };
 
+static io_block_dev_spec_t boot_dev_spec = {
+	.buffer = {
+		.offset = BAIKAL_FIP_BASE,
+		.length = BAIKAL_FIP_MAX_SIZE
+	},
+	.block_size = MMC_BLOCK_SIZE
+};
+
 static const io_uuid_spec_t bl2_uuid_spec = {
 	.uuid = UUID_TRUSTED_BOOT_FIRMWARE_BL2,
 };
@@ -98,7 +113,7 @@ static const io_uuid_spec_t bl33_cert_uuid_spec = {
 #endif /* TRUSTED_BOARD_BOOT */
 
 static int open_fip(const uintptr_t spec);
-static int open_memmap(const uintptr_t spec);
+static int open_boot_dev(const uintptr_t spec);
 
 struct plat_io_policy {
 	uintptr_t *dev_handle;
@@ -109,9 +124,9 @@ struct plat_io_policy {
 /* By default, ARM platforms load images from the FIP */
 static const struct plat_io_policy policies[] = {
 	[FIP_IMAGE_ID] = {
-		&memmap_dev_handle,
+		&boot_dev_handle,
 		(uintptr_t)&fip_block_spec,
-		open_memmap
+		open_boot_dev
 	},
 	[BL2_IMAGE_ID] = {
 		&fip_dev_handle,
@@ -205,13 +220,6 @@ static int open_fip(const uintptr_t spec)
 	return local_image_handle;
 }
 
-#ifdef IMAGE_BL1
-/* Return 0 for equal uuids. */
-static inline int compare_uuids(const uuid_t *uuid1, const uuid_t *uuid2)
-{
-	return memcmp(uuid1, uuid2, sizeof(uuid_t));
-}
-
 size_t bootflash_read_blocks(int lba, uintptr_t buf, size_t size)
 {
 	if (bootflash_read(lba * MMC_BLOCK_SIZE, (void *)buf, size)) {
@@ -221,6 +229,16 @@ size_t bootflash_read_blocks(int lba, uintptr_t buf, size_t size)
 	}
 }
 
+static inline int is_valid_header(fip_toc_header_t *header)
+{
+	if ((header->name == TOC_HEADER_NAME) && (header->serial_number != 0)) {
+		return 1;
+	} else {
+		return 0;
+	}
+}
+
+#ifdef IMAGE_BL1
 /* TODO: use io_open, io_read */
 static int read_fdt(uintptr_t src, uintptr_t dst, void *func)
 {
@@ -263,70 +281,6 @@ static int read_fdt(uintptr_t src, uintptr_t dst, void *func)
 
 	return 0;
 }
-static int read_fip(uintptr_t src, uintptr_t dst, uintptr_t local_image_handle, void *func)
-{
-	size_t (*read_blocks)(int lba, uintptr_t dst, size_t size) = func;
-	fip_toc_entry_t entry = {0};
-	int result, size = 0;
-	size_t bytes_read;
-	static const uuid_t uuid_null = {0};
-
-	/* Read FIP Header part */
-	result = io_seek(local_image_handle, IO_SEEK_SET, sizeof(fip_toc_header_t));
-	if (result != 0) {
-		VERBOSE("%s: -- io_seek\n", __func__);
-		return -1;
-	}
-
-	result = read_blocks((src / MMC_BLOCK_SIZE),
-		ROUND_DOWN(dst),
-		ROUND_UP(sizeof(fip_toc_header_t)));
-	if (!result) {
-		VERBOSE("%s: -- read_blocks\n", __func__);
-		return -1;
-	}
-
-	src += sizeof(fip_toc_header_t);
-	dst += sizeof(fip_toc_header_t);
-	do {
-		result = read_blocks((src / MMC_BLOCK_SIZE),
-			ROUND_DOWN(dst),
-			ROUND_UP(sizeof(fip_toc_entry_t)));
-		if (!result) {
-			VERBOSE("%s: -- read_blocks\n", __func__);
-			return -1;
-		}
-
-		result = io_read(local_image_handle,
-				 (uintptr_t)&entry,
-				 sizeof(entry),
-				 &bytes_read);
-		if (result != 0) {
-			VERBOSE("%s: -- io_read\n", __func__);
-			return -1;
-		}
-
-		src += sizeof(fip_toc_entry_t);
-		dst += sizeof(fip_toc_entry_t);
-		size += entry.size;
-
-	} while (compare_uuids(&entry.uuid, &uuid_null) != 0);
-
-	result = read_blocks((src / MMC_BLOCK_SIZE),
-		ROUND_DOWN(dst),
-		ROUND_UP(size));
-	if (!result) {
-		VERBOSE("%s: -- read_blocks\n", __func__);
-		return -1;
-	}
-
-	INFO("BL1: FIP crc32:0x%08x size:%lu\n",
-		crc32((void *)BAIKAL_FIP_BASE, dst + size - BAIKAL_FIP_BASE, 0),
-		dst + size - BAIKAL_FIP_BASE);
-
-	return 0;
-}
-
 #ifdef BAIKAL_SD_FIRMWARE_DEBUG
 int mmc_test(uint32_t dst)
 {
@@ -378,10 +332,121 @@ int mmc_copy(uint32_t dst, uint32_t src, uint32_t size)
 }
 #endif /* BAIKAL_SD_FIRMWARE_DEBUG */
 
-static int read_image(uintptr_t local_image_handle)
+#ifdef BAIKAL_CRC_BENCH
+/*
+ * Read the whole FIP into the bounce buffer for the crc32 benchmark, the
+ * images are otherwise read on demand. The ToC is read block by block up
+ * to its terminating entry, then the span covered by the entries.
+ * Return the FIP length or 0 on error.
+ */
+static size_t read_fip(uintptr_t src, void *func)
 {
+	size_t (*read_blocks)(int lba, uintptr_t dst, size_t size) = func;
+	static const uuid_t uuid_null;
+	const fip_toc_entry_t *entry;
+	size_t loaded = MMC_BLOCK_SIZE; /* the header block is already read */
+	size_t size = 0;
+	size_t toc_end;
+
+	entry = (void *)(BAIKAL_FIP_BASE + sizeof(fip_toc_header_t));
+	for (;; entry++) {
+		toc_end = (uintptr_t)(entry + 1) - BAIKAL_FIP_BASE;
+		if (toc_end > BAIKAL_FIP_MAX_SIZE) {
+			VERBOSE("%s: -- broken toc\n", __func__);
+			return 0;
+		}
+
+		if (toc_end > loaded) {
+			if (read_blocks((src + loaded) / MMC_BLOCK_SIZE,
+					BAIKAL_FIP_BASE + loaded,
+					MMC_BLOCK_SIZE) != MMC_BLOCK_SIZE) {
+				VERBOSE("%s: -- read_blocks\n", __func__);
+				return 0;
+			}
+
+			loaded += MMC_BLOCK_SIZE;
+		}
+
+		if (memcmp(&entry->uuid, &uuid_null, sizeof(uuid_t)) == 0) {
+			break;
+		}
+
+		if (entry->offset_address > BAIKAL_FIP_MAX_SIZE ||
+		    entry->size > BAIKAL_FIP_MAX_SIZE - entry->offset_address) {
+			VERBOSE("%s: -- broken toc entry\n", __func__);
+			return 0;
+		}
+
+		size = MAX(size, entry->offset_address + entry->size);
+	}
+
+	size = MAX(size, toc_end);
+	if (size > loaded &&
+	    !read_blocks((src + loaded) / MMC_BLOCK_SIZE,
+			 BAIKAL_FIP_BASE + loaded,
+			 ROUND_UP(size - loaded))) {
+		VERBOSE("%s: -- read_blocks\n", __func__);
+		return 0;
+	}
+
+	return size;
+}
+#endif
+#endif /* IMAGE_BL1 */
+
+/*
+ * Check that the device holds a valid FIP (BL1 also loads the DTB from it)
+ * and make it the backend of the FIP image.
+ */
+static int boot_dev_probe(uintptr_t dev_base, void *func)
+{
+	size_t (*read_blocks)(int lba, uintptr_t dst, size_t size) = func;
+	size_t bytes_read;
+#if defined(IMAGE_BL1) && defined(BAIKAL_CRC_BENCH)
+	size_t fip_size;
+#endif
+
+#ifdef IMAGE_BL1
+	baikal_boot_ts(BAIKAL_TS_BOOT_DEV_PROBE_START);
+	if (read_fdt(dev_base + BAIKAL_DTB_OFFSET, BAIKAL_SEC_DTB_BASE, func)) {
+		return -1;
+	}
+#endif
+	bytes_read = read_blocks((dev_base + BAIKAL_FIP_OFFSET) / MMC_BLOCK_SIZE,
+				 BAIKAL_FIP_BASE,
+				 MMC_BLOCK_SIZE);
+	if (bytes_read != MMC_BLOCK_SIZE ||
+	    !is_valid_header((fip_toc_header_t *)BAIKAL_FIP_BASE)) {
+		VERBOSE("%s: -- broken fip\n", __func__);
+		return -1;
+	}
+
+	boot_dev_spec.ops.read = read_blocks;
+	fip_block_spec.offset = dev_base + BAIKAL_FIP_OFFSET;
+#ifdef IMAGE_BL1
+	baikal_boot_ts(BAIKAL_TS_BOOT_DEV_PROBE_END);
+#ifdef BAIKAL_CRC_BENCH
+	fip_size = read_fip(dev_base + BAIKAL_FIP_OFFSET, func);
+	if (fip_size != 0) {
+		INFO("BL1: FIP crc32:0x%08x size:%lu\n",
+			crc32((void *)BAIKAL_FIP_BASE, fip_size, 0),
+			fip_size);
+		crc_bench((void *)BAIKAL_FIP_BASE, fip_size);
+	}
+#endif
+#endif
+	return 0;
+}
+
+static int boot_dev_select(void)
+{
+	static bool selected;
 	int ret;
 
+	if (selected) {
+		return 0;
+	}
+
 	/* sd */
 #ifdef BAIKAL_SD_FIRMWARE
 	ret = dw_mshc_init();
@@ -389,6 +454,7 @@ static int read_image(uintptr_t local_image_handle)
 		goto skip;
 	}
 
+#ifdef IMAGE_BL1
 #ifdef BAIKAL_SD_FIRMWARE_TEST
 	VERBOSE("BL1: test sd/mmc...\n");
 	ret = mmc_test(BAIKAL_SD_FIRMWARE_OFFSET);
@@ -404,19 +470,20 @@ static int read_image(uintptr_t local_image_handle)
 		goto skip;
 	}
 #endif /* BAIKAL_SD_FIRMWARE_DEBUG */
+#endif /* IMAGE_BL1 */
 
-	VERBOSE("BL1: read firmware from sd/mmc...\n");
-	ret = read_fdt(BAIKAL_SD_FIRMWARE_OFFSET + BAIKAL_DTB_OFFSET, BAIKAL_SEC_DTB_BASE, (void *)mmc_read_blocks);
-	if (ret) {
-		goto skip;
-	}
-	ret = read_fip(BAIKAL_SD_FIRMWARE_OFFSET + BAIKAL_FIP_OFFSET, BAIKAL_FIP_BASE, local_image_handle, (void *)mmc_read_blocks);
+	VERBOSE("%s: use firmware from sd/mmc...\n", __func__);
+	ret = boot_dev_probe(BAIKAL_SD_FIRMWARE_OFFSET, (void *)mmc_read_blocks);
 
 skip:
-	dw_mshc_off();
 	if (ret == 0) {
+		/* The controller is switched off by plat_baikal_io_exit() */
+		boot_dev_is_sd = true;
+		selected = true;
 		return ret;
 	}
+
+	dw_mshc_off();
 #endif /* BAIKAL_SD_FIRMWARE */
 
 	/* flash */
@@ -424,43 +491,29 @@ skip:
 	if (ret) {
 		return ret;
 	}
-	VERBOSE("BL1: read firmware from spi flash...\n");
-	ret  = read_fdt(BAIKAL_DTB_OFFSET, BAIKAL_SEC_DTB_BASE, (void *)bootflash_read_blocks);
-	if (ret) {
-		return ret;
+	VERBOSE("%s: use firmware from spi flash...\n", __func__);
+	ret = boot_dev_probe(0, (void *)bootflash_read_blocks);
+	if (ret == 0) {
+		selected = true;
 	}
-	ret = read_fip(BAIKAL_FIP_OFFSET, BAIKAL_FIP_BASE, local_image_handle, (void *)bootflash_read_blocks);
-	return ret;
-}
-#endif /* IMAGE_BL1 */
 
-static inline int is_valid_header(fip_toc_header_t *header)
-{
-	if ((header->name == TOC_HEADER_NAME) && (header->serial_number != 0)) {
-		return 1;
-	} else {
-		return 0;
-	}
+	return ret;
 }
 
-static int open_memmap(const uintptr_t spec)
+static int open_boot_dev(const uintptr_t spec)
 {
 	int result;
 	uintptr_t local_image_handle;
 
-	result = io_dev_init(memmap_dev_handle, (uintptr_t)NULL);
+	result = boot_dev_select();
+	if (result) {
+		return result;
+	}
 
+	result = io_dev_init(boot_dev_handle, (uintptr_t)NULL);
 	if (result == 0) {
-		result = io_open(memmap_dev_handle, spec, &local_image_handle);
+		result = io_open(boot_dev_handle, spec, &local_image_handle);
 		if (result == 0) {
-#ifdef IMAGE_BL1
-			result = read_image(local_image_handle);
-#endif
-			if (!(is_valid_header((fip_toc_header_t *)BAIKAL_FIP_BASE))) {
-				VERBOSE("%s: -- broken fip\n", __func__);
-				result = -1;
-			}
-
 			io_close(local_image_handle);
 		}
 	}
@@ -475,7 +528,7 @@ void plat_baikal_io_setup(void)
 	io_result = register_io_dev_fip(&fip_dev_con);
 	assert(io_result == 0);
 
-	io_result = register_io_dev_memmap(&memmap_dev_con);
+	io_result = register_io_dev_block(&boot_dev_con);
 	assert(io_result == 0);
 
 	/* Open connections to devices and cache the handles */
@@ -483,14 +536,27 @@ void plat_baikal_io_setup(void)
 				&fip_dev_handle);
 	assert(io_result == 0);
 
-	io_result = io_dev_open(memmap_dev_con, (uintptr_t)NULL,
-				&memmap_dev_handle);
+	io_result = io_dev_open(boot_dev_con, (uintptr_t)&boot_dev_spec,
+				&boot_dev_handle);
 	assert(io_result == 0);
 
 	/* Ignore improbable errors in release builds */
 	(void)io_result;
 }
 
+/*
+ * Called once the stage has loaded all its images from the boot device.
+ */
+void plat_baikal_io_exit(void)
+{
+#ifdef BAIKAL_SD_FIRMWARE
+	if (boot_dev_is_sd) {
+		dw_mshc_off();
+		boot_dev_is_sd = false;
+	}
+#endif
+}
+
 /*
  * Return an IO device handle and specification which can be used to access
  * an image. Use this to enforce platform load policy
@@ -17,6 +17,7 @@
 
 #include <baikal_mshc.h>
 #include <baikal_def.h>
+#include <platform_def.h>
 
 /* TODO: rework */
 #if defined(BAIKAL_DBM10) || defined(BAIKAL_DBM20) || \
@@ -24,6 +25,19 @@
 #include <bm1000_cmu.h>
 #endif
 
+/*
+ * ADMA2 descriptor table. In 26-bit length mode a single descriptor covers
+ * up to 64 MiB, so a few entries are enough for a whole FIP image.
+ */
+static sdhci_adma2_desc_t adma2_desc[SDHCI_ADMA2_DESC_NUM]
+	__aligned(CACHE_WRITEBACK_GRANULE);
+static bool adma2_supported;
+static bool adma2_xfer;
+
+static struct mmc_device_info mshc_info;
+static bool app_cmd;
+static bool emmc_hs_timing;	/* the eMMC HS_TIMING switch has succeeded */
+
 static int reg_size(int Reg)
 {
 	int size = 0;
@@ -143,10 +157,12 @@ static int speed_mode(uintptr_t base, uint32_t mode)
 	switch (mode) {
 	case SD_DEFAULT:
 		ctrl1 &= ~SDHCI_CTRL_HISPD;
+		ctrl2 &= ~SDHCI_CTRL_UHS_MASK;
 		ctrl2 &= ~SDHCI_CTRL_VDD_180;
 		break;
 	case SD_HIGH:
 		ctrl1 |=  SDHCI_CTRL_HISPD;
+		ctrl2 &= ~SDHCI_CTRL_UHS_MASK;
 		ctrl2 &= ~SDHCI_CTRL_VDD_180;
 		break;
 	case SD_12:
@@ -169,6 +185,12 @@ static int speed_mode(uintptr_t base, uint32_t mode)
 		ctrl2 |=  SDHCI_CTRL_UHS_DDR50;
 		ctrl2 |=  SDHCI_CTRL_VDD_180;
 		break;
+	case DD_52:
+		ctrl1 |=  SDHCI_CTRL_HISPD;
+		ctrl2 &= ~SDHCI_CTRL_UHS_MASK;
+		ctrl2 |=  SDHCI_CTRL_UHS_DDR50;
+		ctrl2 &= ~SDHCI_CTRL_VDD_180;
+		break;
 	default:
 		return -1;
 	}
@@ -192,7 +214,8 @@ static int clock_supply(uintptr_t base, uint32_t Freq)
 	/* TODO: rework */
 	/* Config */
 #if defined(BM1000_CMU_H)
-	int Div = MMAVLSP_PLL_FREQ / (2 * Freq);
+	/* Round the divider up: the card clock must not exceed the mode limit */
+	int Div = DIV_ROUND_UP(MMAVLSP_PLL_FREQ, 2 * Freq);
 
 	cmu_clkch_enable_by_base(MMAVLSP_CMU0_CLKCHCTL_MSHC_TX_X2, Div);
 #elif defined(BS1000_CMU_H)
@@ -241,10 +264,12 @@ static int config_width(uintptr_t base, uint32_t width)
 		reg->ext_width = 0;
 		break;
 	case MMC_BUS_WIDTH_4:
+	case MMC_BUS_WIDTH_DDR_4:
 		reg->width     = 1;
 		reg->ext_width = 0;
 		break;
 	case MMC_BUS_WIDTH_8:
+	case MMC_BUS_WIDTH_DDR_8:
 		reg->width     = 0;
 		reg->ext_width = 1;
 		break;
@@ -306,6 +331,122 @@ static int init_host(uintptr_t base)
 	return 0;
 }
 
+static void adma2_init(uintptr_t base)
+{
+	uint32_t caps = reg_read(base, SDHCI_CAPABILITIES);
+	int ctrl;
+
+	adma2_supported = (caps & SDHCI_CAN_DO_ADMA2) && (caps & SDHCI_CAN_64BIT_V4);
+	if (!adma2_supported) {
+		return;
+	}
+
+	/* In v4 mode, ADMA2 with 64-bit addressing is selected by ADMA32 */
+	ctrl  = reg_read(base, SDHCI_HOST_CONTROL);
+	ctrl &= ~SDHCI_CTRL_DMA_MASK;
+	ctrl |=  SDHCI_CTRL_ADMA32;
+	reg_write(base, ctrl, SDHCI_HOST_CONTROL);
+
+	ctrl  = reg_read(base, SDHCI_HOST_CONTROL2);
+	ctrl |= SDHCI_CTRL_ADMA2_LEN_MODE;
+	reg_write(base, ctrl, SDHCI_HOST_CONTROL2);
+}
+
+/*
+ * Build a descriptor chain for the buffer. Only block-aligned buffers are
+ * transferred by DMA: this covers the image loads, while the small internal
+ * buffers of the MMC framework (SCR, EXT_CSD) stay on PIO.
+ */
+static int adma2_setup(uintptr_t base, uintptr_t buf, size_t size)
+{
+	unsigned int i;
+
+	if (!adma2_supported ||
+	    (buf % SDHCI_DEFAULT_BLOCK_SIZE) ||
+	    (size % SDHCI_DEFAULT_BLOCK_SIZE)) {
+		return -1;
+	}
+
+	for (i = 0; size > 0; ++i) {
+		/* A descriptor must not cross a 128 MiB boundary */
+		size_t len = SDHCI_ADMA2_BOUNDARY - (buf % SDHCI_ADMA2_BOUNDARY);
+
+		if (i == ARRAY_SIZE(adma2_desc)) {
+			return -1;
+		}
+
+		len = MIN(len, size);
+		len = MIN(len, (size_t)SDHCI_ADMA2_MAX_LEN);
+
+		adma2_desc[i].attr = SDHCI_ADMA2_VALID | SDHCI_ADMA2_ACT_TRAN |
+				     ((len >> 16) << SDHCI_ADMA2_LEN_HI_SHIFT);
+		adma2_desc[i].len = len & 0xffff;
+		adma2_desc[i].addr_lo = buf & 0xffffffff;
+		adma2_desc[i].addr_hi = (uint64_t)buf >> 32;
+		adma2_desc[i].reserved = 0;
+
+		buf  += len;
+		size -= len;
+	}
+
+	adma2_desc[i - 1].attr |= SDHCI_ADMA2_END;
+	flush_dcache_range((uintptr_t)adma2_desc, sizeof(adma2_desc));
+
+	reg_write(base, (uintptr_t)adma2_desc & 0xffffffff, SDHCI_ADMA_ADDRESS);
+	reg_write(base, (uint64_t)(uintptr_t)adma2_desc >> 32, SDHCI_ADMA_ADDRESS_HI);
+	return 0;
+}
+
+static int adma2_wait(uintptr_t base, uintptr_t buf, size_t size, bool read)
+{
+	/* 100 ms plus the transfer time at no less than 8 MB/s */
+	uint64_t timeout = timeout_init_us(100 * 1000 + size / 8);
+	int ret = 0;
+	int status;
+
+	adma2_xfer = false;
+
+	led_on(base, true);
+	for (;;) {
+		status = reg_read(base, SDHCI_INT_STATUS);
+		if (status & (SDHCI_INT_DATA_END | SDHCI_INT_ERROR)) {
+			break;
+		}
+
+		if (timeout_elapsed(timeout)) {
+			ret = -1;
+			goto exit;
+		}
+	}
+
+	reg_write(base, SDHCI_INT_DATA_END | SDHCI_INT_DMA_END, SDHCI_INT_STATUS);
+
+	/* error */
+	if (reg_read(base, SDHCI_ERR_STATUS)) {
+		ERROR("%s: err:0x%x adma:0x%x\n", __func__,
+		      reg_read(base, SDHCI_ERR_STATUS),
+		      reg_read(base, SDHCI_ADMA_ERROR));
+		ret = -1;
+		reg_write(base, 0xffff, SDHCI_ERR_STATUS);
+		goto exit;
+	}
+
+exit:
+	if (ret) {
+		reg_write(base, SDHCI_RESET_CMD,  SDHCI_SOFTWARE_RESET);
+		reg_write(base, SDHCI_RESET_DATA, SDHCI_SOFTWARE_RESET);
+		WAIT(reg_read(base, SDHCI_SOFTWARE_RESET));
+	}
+
+	if (read) {
+		/* Drop lines speculatively fetched while the DMA was running */
+		inv_dcache_range(buf, size);
+	}
+
+	led_on(base, false);
+	return ret;
+}
+
 /*
  * ops
  */
@@ -346,6 +487,17 @@ static int dw_send_cmd(struct mmc_cmd *cmd)
 		Cmd->data_present = 1;   /* 0-nodata, 1-data */
 	}
 
+	/*
+	 * CMD8 is SEND_EXT_CSD on eMMC and CMD6 is SWITCH_FUNC on SD (but not
+	 * ACMD6, SET_BUS_WIDTH): both return a data block.
+	 */
+	if ((Cmd->index == MMC_CMD(8) && mshc_info.mmc_dev_type == MMC_IS_EMMC) ||
+	    (Cmd->index == MMC_CMD(6) && mshc_info.mmc_dev_type != MMC_IS_EMMC && !app_cmd)) {
+		Cmd->data_present = 1;
+	}
+
+	app_cmd = Cmd->index == MMC_CMD(55);
+
 	/* mode */
 	uint32_t Mode = reg_read(base, SDHCI_TRANSFER_MODE);
 	reg_mode_t *mode = (void *)&Mode;
@@ -423,6 +575,13 @@ static int dw_prepare(int lba, uintptr_t buf, size_t size)
 		mode->multi_block  = 1;
 	}
 
+	adma2_xfer = !adma2_setup(base, buf, size);
+	if (adma2_xfer) {
+		/* Write back the source data and evict the destination lines */
+		flush_dcache_range(buf, size);
+		mode->dma_en = 1;
+	}
+
 	reg_write(base, Blocksize, SDHCI_BLOCK_SIZE);
 	reg_write(base, Blocks,    SDHCI_32BIT_BLK_CNT);
 	reg_write(base, Mode,      SDHCI_TRANSFER_MODE);
@@ -440,6 +599,10 @@ static int dw_read(int lba, uintptr_t buf, size_t size)
 	uint32_t Blocksize = reg_read(base, SDHCI_BLOCK_SIZE);
 	uint32_t Blocks    = reg_read(base, SDHCI_32BIT_BLK_CNT);
 
+	if (adma2_xfer) {
+		return adma2_wait(base, buf, size, true);
+	}
+
 	led_on(base, true);
 	for (j = 0; j < Blocks; j++) {
 		ret = WAIT(!(reg_read(base, SDHCI_INT_STATUS) & SDHCI_INT_DATA_AVAIL));
@@ -491,6 +654,10 @@ static int dw_write(int lba, uintptr_t buf, size_t size)
 	uint32_t Blocksize = reg_read(base, SDHCI_BLOCK_SIZE);
 	uint32_t Blocks    = reg_read(base, SDHCI_32BIT_BLK_CNT);
 
+	if (adma2_xfer) {
+		return adma2_wait(base, buf, size, false);
+	}
+
 	led_on(base, true);
 	for (j = 0; j < Blocks; j++) {
 		ret = WAIT(!(reg_read(base, SDHCI_INT_STATUS) & SDHCI_INT_SPACE_AVAIL));
@@ -533,6 +700,28 @@ exit:
 static int dw_set_ios(unsigned int clk, unsigned int width)
 {
 	uintptr_t base = MMAVLSP_EMMC_BASE;
+	unsigned int max_freq = mshc_info.max_bus_freq;
+
+	/*
+	 * Stay within the legacy limit and timing until the card has been
+	 * switched to a high speed mode. An SD card reports more than 25 MHz
+	 * only after the CMD6 switch, while the CSD of an eMMC already
+	 * reports 26 MHz in the legacy timing.
+	 */
+	if (max_freq == 0 || max_freq > SDHCI_EMMC_HS_CLOCK ||
+	    (mshc_info.mmc_dev_type == MMC_IS_EMMC && !emmc_hs_timing)) {
+		max_freq = SDHCI_LEGACY_CLOCK;
+	}
+
+	clk = MIN(clk, max_freq);
+
+	if (width == MMC_BUS_WIDTH_DDR_4 || width == MMC_BUS_WIDTH_DDR_8) {
+		speed_mode(base, DD_52);
+	} else if (clk > SDHCI_LEGACY_CLOCK) {
+		speed_mode(base, SD_HIGH);
+	} else {
+		speed_mode(base, SD_DEFAULT);
+	}
 
 	clock_supply(base, clk);
 	config_width(base, width);
@@ -546,6 +735,7 @@ static void dw_init(void)
 	init_host(base);
 	clock_supply(base, SDHCI_INIT_CLOCK);
 	speed_mode(base, SD_DEFAULT);
+	adma2_init(base);
 }
 
 void dw_mshc_off(void)
@@ -564,22 +754,176 @@ static const struct mmc_ops dw_mmc_ops = {
 	.write		= dw_write,
 };
 
+/*
+ * Read a single block to check that the bus works in the current mode.
+ * The FIP area is used as a scratch buffer: it has not been loaded yet.
+ */
+static int verify_read(void)
+{
+	uintptr_t base = MMAVLSP_EMMC_BASE;
+
+	if (mmc_read_blocks(0, BAIKAL_FIP_BASE, MMC_BLOCK_SIZE) == MMC_BLOCK_SIZE) {
+		return 0;
+	}
+
+	reg_write(base, SDHCI_RESET_CMD,  SDHCI_SOFTWARE_RESET);
+	reg_write(base, SDHCI_RESET_DATA, SDHCI_SOFTWARE_RESET);
+	WAIT(reg_read(base, SDHCI_SOFTWARE_RESET));
+	reg_write(base, 0xffff, SDHCI_ERR_STATUS);
+	return -1;
+}
+
+static void sd_speed_setup(void)
+{
+	/* The generic layer has switched the card to High Speed via CMD6 */
+	if (mshc_info.max_bus_freq <= SDHCI_LEGACY_CLOCK) {
+		return;
+	}
+
+	if (verify_read()) {
+		WARN("%s: high speed failed, fall back to %u Hz\n", __func__,
+		     SDHCI_LEGACY_CLOCK);
+		mshc_info.max_bus_freq = SDHCI_LEGACY_CLOCK;
+		dw_set_ios(SDHCI_LEGACY_CLOCK, MMC_BUS_WIDTH_4);
+	}
+}
+
+#define EXT_CSD_CARD_TYPE		196
+#define  EXT_CSD_CARD_TYPE_HS_52	(1 << 1)
+#define  EXT_CSD_CARD_TYPE_DDR_52	(1 << 2)
+
+static int emmc_switch(unsigned int index, unsigned int value)
+{
+	struct mmc_cmd cmd;
+	int ret;
+	int try = 1000;
+
+	memset(&cmd, 0, sizeof(cmd));
+	cmd.cmd_idx = MMC_CMD(6);
+	cmd.cmd_arg = EXTCSD_WRITE_BYTES | EXTCSD_CMD(index) |
+		      EXTCSD_VALUE(value) | EXTCSD_CMD_SET_NORMAL;
+	cmd.resp_type = MMC_RESPONSE_R1B;
+	ret = dw_send_cmd(&cmd);
+	if (ret) {
+		return ret;
+	}
+
+	do {
+		memset(&cmd, 0, sizeof(cmd));
+		cmd.cmd_idx = MMC_CMD(13);
+		cmd.cmd_arg = MMC_FIX_RCA << RCA_SHIFT_OFFSET;
+		cmd.resp_type = MMC_RESPONSE_R1;
+		ret = dw_send_cmd(&cmd);
+		if (ret) {
+			return ret;
+		}
+
+		if (cmd.resp_data[0] & STATUS_SWITCH_ERROR) {
+			return -1;
+		}
+
+		if (!try--) {
+			return -1;
+		}
+	} while (MMC_GET_STATE(cmd.resp_data[0]) != MMC_STATE_TRAN);
+
+	return 0;
+}
+
+static int emmc_card_type(void)
+{
+	const uint8_t *ext_csd = (const uint8_t *)BAIKAL_FIP_BASE;
+	struct mmc_cmd cmd;
+	int ret;
+
+	ret = dw_prepare(0, BAIKAL_FIP_BASE, MMC_BLOCK_SIZE);
+	if (ret) {
+		return ret;
+	}
+
+	memset(&cmd, 0, sizeof(cmd));
+	cmd.cmd_idx = MMC_CMD(8);
+	cmd.resp_type = MMC_RESPONSE_R1;
+	ret = dw_send_cmd(&cmd);
+	if (ret) {
+		return ret;
+	}
+
+	ret = dw_read(0, BAIKAL_FIP_BASE, MMC_BLOCK_SIZE);
+	if (ret) {
+		return ret;
+	}
+
+	return ext_csd[EXT_CSD_CARD_TYPE];
+}
+
+/*
+ * Step the eMMC up from the legacy mode: HS52 SDR first, then DDR52. Each
+ * step is verified with a block read and undone if the bus does not work.
+ * HS200 is not attempted: it needs 1.8V I/O, while the MSHC is powered
+ * from 3.3V.
+ */
+static void emmc_speed_setup(void)
+{
+	int card_type = emmc_card_type();
+
+	if (card_type < 0 || !(card_type & EXT_CSD_CARD_TYPE_HS_52)) {
+		return;
+	}
+
+	if (emmc_switch(CMD_EXTCSD_HS_TIMING, 1)) {
+		return;
+	}
+
+	emmc_hs_timing = true;
+	mshc_info.max_bus_freq = SDHCI_EMMC_HS_CLOCK;
+	dw_set_ios(SDHCI_EMMC_HS_CLOCK, MMC_BUS_WIDTH_8);
+	if (verify_read()) {
+		WARN("%s: HS52 failed, fall back to %u Hz\n", __func__,
+		     SDHCI_LEGACY_CLOCK);
+		emmc_hs_timing = false;
+		mshc_info.max_bus_freq = SDHCI_LEGACY_CLOCK;
+		dw_set_ios(SDHCI_LEGACY_CLOCK, MMC_BUS_WIDTH_8);
+		emmc_switch(CMD_EXTCSD_HS_TIMING, 0);
+		return;
+	}
+
+	if (!(card_type & EXT_CSD_CARD_TYPE_DDR_52) ||
+	    emmc_switch(CMD_EXTCSD_BUS_WIDTH, MMC_BUS_WIDTH_DDR_8)) {
+		return;
+	}
+
+	dw_set_ios(SDHCI_EMMC_HS_CLOCK, MMC_BUS_WIDTH_DDR_8);
+	if (verify_read()) {
+		WARN("%s: DDR52 failed, fall back to HS52\n", __func__);
+		dw_set_ios(SDHCI_EMMC_HS_CLOCK, MMC_BUS_WIDTH_8);
+		emmc_switch(CMD_EXTCSD_BUS_WIDTH, MMC_BUS_WIDTH_8);
+	}
+}
+
 int dw_mshc_init(void)
 {
 	int err;
-	static struct mmc_device_info info;
 
-	memset(&info, 0, sizeof(info));
-#if 0
+	memset(&mshc_info, 0, sizeof(mshc_info));
+	app_cmd = false;
+	emmc_hs_timing = false;
+#ifdef BAIKAL_MSHC_EMMC
 	/* eMMC */
-	info.mmc_dev_type = MMC_IS_EMMC;
-	info.ocr_voltage = OCR_3_2_3_3;
-	err = mmc_init(&dw_mmc_ops, SDHCI_DEFAULT_CLOCK, MMC_BUS_WIDTH_8, MMC_FLAG_CMD23, &info);
+	mshc_info.mmc_dev_type = MMC_IS_EMMC;
+	mshc_info.ocr_voltage = OCR_3_2_3_3;
+	err = mmc_init(&dw_mmc_ops, SDHCI_DEFAULT_CLOCK, MMC_BUS_WIDTH_8, MMC_FLAG_CMD23, &mshc_info);
+	if (!err) {
+		emmc_speed_setup();
+	}
 #else
 	/* SD */
-	info.mmc_dev_type = MMC_IS_SD;
-	info.ocr_voltage = OCR_3_2_3_3;
-	err = mmc_init(&dw_mmc_ops, SDHCI_DEFAULT_CLOCK, MMC_BUS_WIDTH_4, 0, &info);
+	mshc_info.mmc_dev_type = MMC_IS_SD;
+	mshc_info.ocr_voltage = OCR_3_2_3_3;
+	err = mmc_init(&dw_mmc_ops, SDHCI_DEFAULT_CLOCK, MMC_BUS_WIDTH_4, MMC_FLAG_SD_CMD6, &mshc_info);
+	if (!err) {
+		sd_speed_setup();
+	}
 #endif
 	return err;
 }
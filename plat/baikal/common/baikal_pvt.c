@@ -4,52 +4,63 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <arch_helpers.h>
 #include <common/debug.h>
 #include <lib/mmio.h>
 #include <lib/utils_def.h>
+#include <lib/xlat_tables/xlat_tables_v2.h>
 
 #include <baikal_def.h>
 #include <baikal_pvt.h>
+#include <baikal_sip_svc.h>
 
-static uintptr_t pvt_get_reg_addr(const uintptr_t base, const unsigned int offset)
-{
-	unsigned int i;
-	static const uintptr_t pvt_bases[] = {
+#define PVT_REG_MAX_OFFSET	0x40
+#define PVT_SHMEM_MAX_SIZE	PAGE_SIZE
+
+static const uintptr_t pvt_bases[] = {
 #if defined(MMCA57_0_PVT_BASE)
-		MMCA57_0_PVT_BASE,
-		MMCA57_1_PVT_BASE,
-		MMCA57_2_PVT_BASE,
-		MMCA57_3_PVT_BASE,
-		MMMALI_PVT_BASE
+	MMCA57_0_PVT_BASE,
+	MMCA57_1_PVT_BASE,
+	MMCA57_2_PVT_BASE,
+	MMCA57_3_PVT_BASE,
+	MMMALI_PVT_BASE
 #elif defined(CA75_0_PVT_BASE)
-		CA75_0_PVT_BASE,
-		CA75_1_PVT_BASE,
-		CA75_2_PVT_BASE,
-		CA75_3_PVT_BASE,
-		CA75_4_PVT_BASE,
-		CA75_5_PVT_BASE,
-		CA75_6_PVT_BASE,
-		CA75_7_PVT_BASE,
-		CA75_8_PVT_BASE,
-		CA75_9_PVT_BASE,
-		CA75_10_PVT_BASE,
-		CA75_11_PVT_BASE,
-		DDR0_PVT_BASE,
-		DDR1_PVT_BASE,
-		DDR2_PVT_BASE,
-		DDR3_PVT_BASE,
-		DDR4_PVT_BASE,
-		DDR5_PVT_BASE,
-		PCIE0_PVT_BASE,
-		PCIE1_PVT_BASE,
-		PCIE2_PVT_BASE,
-		PCIE3_PVT_BASE,
-		PCIE4_PVT_BASE
+	CA75_0_PVT_BASE,
+	CA75_1_PVT_BASE,
+	CA75_2_PVT_BASE,
+	CA75_3_PVT_BASE,
+	CA75_4_PVT_BASE,
+	CA75_5_PVT_BASE,
+	CA75_6_PVT_BASE,
+	CA75_7_PVT_BASE,
+	CA75_8_PVT_BASE,
+	CA75_9_PVT_BASE,
+	CA75_10_PVT_BASE,
+	CA75_11_PVT_BASE,
+	DDR0_PVT_BASE,
+	DDR1_PVT_BASE,
+	DDR2_PVT_BASE,
+	DDR3_PVT_BASE,
+	DDR4_PVT_BASE,
+	DDR5_PVT_BASE,
+	PCIE0_PVT_BASE,
+	PCIE1_PVT_BASE,
+	PCIE2_PVT_BASE,
+	PCIE3_PVT_BASE,
+	PCIE4_PVT_BASE
 #endif
-	};
+};
+
+/* Non-secure buffer registered by PVT_SHMEM_SET */
+static uintptr_t pvt_shmem_va;
+static size_t pvt_shmem_size;
+
+static uintptr_t pvt_get_reg_addr(const uintptr_t base, const unsigned int offset)
+{
+	unsigned int i;
 
 	/* Ensure that the offset in PVT region range */
-	if (offset > 0x40) {
+	if (offset > PVT_REG_MAX_OFFSET) {
 		return 0;
 	}
 
@@ -87,3 +98,112 @@ uint32_t pvt_write_reg(const uintptr_t base, const unsigned int offset, const ui
 #endif
 	return 0;
 }
+
+static int64_t pvt_shmem_map(const uint64_t base, const uint64_t size)
+{
+	int err;
+
+	if (pvt_shmem_size) {
+		err = mmap_remove_dynamic_region(pvt_shmem_va, pvt_shmem_size);
+		if (err) {
+			ERROR("%s: unable to unmap shmem, err %d\n", __func__, err);
+			return -1;
+		}
+
+		pvt_shmem_va = 0;
+		pvt_shmem_size = 0;
+	}
+
+	/* Zero size unregisters the buffer */
+	if (!size) {
+		return 0;
+	}
+
+	if (!IS_PAGE_ALIGNED(base) || !IS_PAGE_ALIGNED(size) ||
+	    size > PVT_SHMEM_MAX_SIZE || !baikal_is_ns_dram(base, size)) {
+		ERROR("%s: invalid shmem 0x%lx, size 0x%lx\n", __func__, base, size);
+		return -1;
+	}
+
+	err = mmap_add_dynamic_region_alloc_va(base, &pvt_shmem_va, size,
+					       MT_MEMORY | MT_RW | MT_NS |
+					       MT_EXECUTE_NEVER);
+	if (err) {
+		ERROR("%s: unable to map shmem 0x%lx, err %d\n", __func__, base, err);
+		pvt_shmem_va = 0;
+		return -1;
+	}
+
+	pvt_shmem_size = size;
+	return 0;
+}
+
+static int64_t pvt_snapshot_fill(const uint32_t mask)
+{
+	unsigned int regs_num = 0;
+	uintptr_t rec_va = pvt_shmem_va;
+	size_t rec_size;
+	unsigned int i;
+
+	for (i = 0; i <= PVT_REG_MAX_OFFSET / 4; ++i) {
+		if (mask & BIT_32(i)) {
+			++regs_num;
+		}
+	}
+
+	rec_size = round_up(sizeof(struct pvt_snapshot) +
+			    regs_num * sizeof(uint32_t), 8);
+
+	if (!regs_num || mask >= BIT_32(PVT_REG_MAX_OFFSET / 4 + 1) ||
+	    ARRAY_SIZE(pvt_bases) * rec_size > pvt_shmem_size) {
+		ERROR("%s: invalid mask 0x%x or shmem size 0x%lx\n", __func__,
+		      mask, pvt_shmem_size);
+		return -1;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(pvt_bases); ++i) {
+		struct pvt_snapshot *const rec = (void *)rec_va;
+		unsigned int n = 0;
+		unsigned int reg;
+
+		rec->base = pvt_bases[i];
+		rec->timestamp = read_cntpct_el0();
+		for (reg = 0; reg <= PVT_REG_MAX_OFFSET / 4; ++reg) {
+			if (mask & BIT_32(reg)) {
+#ifdef BAIKAL_QEMU
+				rec->regs[n++] = 0;
+#else
+				rec->regs[n++] = mmio_read_32(pvt_bases[i] + reg * 4);
+#endif
+			}
+		}
+
+		rec_va += rec_size;
+	}
+
+	return rec_va - pvt_shmem_va;
+}
+
+/*
+ * The shared buffer is unmapped by PVT_SHMEM_SET and written by PVT_SNAPSHOT:
+ * both are served under the lock of the BL31 dynamic mappings.
+ */
+int64_t pvt_shmem_set(const uint64_t base, const uint64_t size)
+{
+	int64_t ret;
+
+	spin_lock(&baikal_mmap_lock);
+	ret = pvt_shmem_map(base, size);
+	spin_unlock(&baikal_mmap_lock);
+	return ret;
+}
+
+int64_t pvt_snapshot(const uint32_t mask)
+{
+	int64_t ret;
+
+	spin_lock(&baikal_mmap_lock);
+	ret = pvt_snapshot_fill(mask);
+	spin_unlock(&baikal_mmap_lock);
+	return ret;
+}
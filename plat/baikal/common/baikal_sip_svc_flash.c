@@ -4,15 +4,23 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <errno.h>
+#include <stdbool.h>
 #include <string.h>
 
 #include <cdefs.h>
 #include <common/debug.h>
+#include <drivers/delay_timer.h>
+#include <lib/xlat_tables/xlat_tables_v2.h>
 
 #include <baikal_bootflash.h>
 #include <baikal_def.h>
 #include <baikal_sip_svc.h>
 
+#define FLASH_SHMEM_MAX_SIZE	BAIKAL_BOOT_SPI_SIZE
+#define FLASH_OP_BUDGET_US	1000 /* max time spent in one CONTINUE call */
+#define FLASH_OP_STEP_TIMEOUT_US 10000000 /* max time of one erase/program step */
+
 static int baikal_smc_flash_init(uint64_t *const data);
 static int baikal_smc_flash_position(const unsigned int pos);
 static int baikal_smc_flash_pull(uint64_t *const data);
@@ -20,22 +28,57 @@ static int baikal_smc_flash_push(const uint64_t data0,
 				 const uint64_t data1,
 				 const uint64_t data2,
 				 const uint64_t data3);
+static int baikal_smc_flash_shmem_set(const uint64_t base,
+				      const uint64_t size);
+static void *baikal_smc_flash_shmem_get(const uint64_t offset,
+					const uint64_t size);
+static int baikal_smc_flash_op_start(const unsigned int op,
+				     const uint64_t addr,
+				     const uint64_t size,
+				     const uint64_t offset);
+static int baikal_smc_flash_op_continue(uint64_t *const data);
+static int baikal_smc_flash_op_status(uint64_t *const data);
 
 static uint8_t flash_buf[1024] __aligned(8);
 static unsigned int flash_buf_idx;
 
-int64_t baikal_smc_flash_handler(const uint32_t smc_fid,
-			     const uint64_t x1,
-			     const uint64_t x2,
-			     const uint64_t x3,
-			     const uint64_t x4,
-			     uint64_t *data)
+/* Non-secure buffer registered by BAIKAL_SMC_FLASH_SHMEM_SET */
+static uintptr_t flash_shmem_va;
+static size_t flash_shmem_size;
+
+/* Operation started by BAIKAL_SMC_FLASH_OP_START */
+static struct {
+	bool active;
+	int err;
+	unsigned int op;
+	uint32_t addr;
+	size_t size;
+	size_t done;
+	uint8_t *data;
+	uint64_t step_timeout;
+} flash_op;
+
+static int64_t baikal_smc_flash_dispatch(const uint32_t smc_fid,
+					 const uint64_t x1,
+					 const uint64_t x2,
+					 const uint64_t x3,
+					 const uint64_t x4,
+					 uint64_t *data)
 {
+	void *buf;
+
 	if ((smc_fid & BIT(30)) == 0) {
 		ERROR("%s: SMC32 (smc_fid 0x%x) is not supported\n", __func__, smc_fid);
 		return -1;
 	}
 
+	if (flash_op.active &&
+	    smc_fid != BAIKAL_SMC_FLASH_OP_CONTINUE &&
+	    smc_fid != BAIKAL_SMC_FLASH_OP_STATUS) {
+		ERROR("%s: flash operation is in progress\n", __func__);
+		return -1;
+	}
+
 	switch (smc_fid) {
 	case BAIKAL_SMC_FLASH_WRITE:
 		return bootflash_write(x1, flash_buf, x2);
@@ -51,12 +94,53 @@ int64_t baikal_smc_flash_handler(const uint32_t smc_fid,
 		return bootflash_erase(x1, x2);
 	case BAIKAL_SMC_FLASH_INIT:
 		return baikal_smc_flash_init(data);
+	case BAIKAL_SMC_FLASH_SHMEM_SET:
+		return baikal_smc_flash_shmem_set(x1, x2);
+	case BAIKAL_SMC_FLASH_SHMEM_WRITE:
+		buf = baikal_smc_flash_shmem_get(x3, x2);
+		if (buf == NULL) {
+			return -1;
+		}
+
+		return bootflash_write(x1, buf, x2);
+	case BAIKAL_SMC_FLASH_SHMEM_READ:
+		buf = baikal_smc_flash_shmem_get(x3, x2);
+		if (buf == NULL) {
+			return -1;
+		}
+
+		return bootflash_read(x1, buf, x2);
+	case BAIKAL_SMC_FLASH_OP_START:
+		return baikal_smc_flash_op_start(x1, x2, x3, x4);
+	case BAIKAL_SMC_FLASH_OP_CONTINUE:
+		return baikal_smc_flash_op_continue(data);
+	case BAIKAL_SMC_FLASH_OP_STATUS:
+		return baikal_smc_flash_op_status(data);
 	default:
 		ERROR("%s: unknown smc_fid 0x%x\n", __func__, smc_fid);
 		return -1;
 	}
 }
 
+/*
+ * The flash state and the shared buffer mapping are global: the SMCs of
+ * all cores are served one at a time.
+ */
+int64_t baikal_smc_flash_handler(const uint32_t smc_fid,
+			     const uint64_t x1,
+			     const uint64_t x2,
+			     const uint64_t x3,
+			     const uint64_t x4,
+			     uint64_t *data)
+{
+	int64_t ret;
+
+	spin_lock(&baikal_mmap_lock);
+	ret = baikal_smc_flash_dispatch(smc_fid, x1, x2, x3, x4, data);
+	spin_unlock(&baikal_mmap_lock);
+	return ret;
+}
+
 static int baikal_smc_flash_init(uint64_t *const data)
 {
 	bootflash_init();
@@ -96,3 +180,165 @@ static int baikal_smc_flash_push(const uint64_t data0,
 	flash_buf_idx += 4 * sizeof(uint64_t);
 	return 0;
 }
+
+static int baikal_smc_flash_shmem_set(const uint64_t base,
+				      const uint64_t size)
+{
+	int err;
+
+	if (flash_shmem_size) {
+		err = mmap_remove_dynamic_region(flash_shmem_va, flash_shmem_size);
+		if (err) {
+			ERROR("%s: unable to unmap shmem, err %d\n", __func__, err);
+			return -1;
+		}
+
+		flash_shmem_va = 0;
+		flash_shmem_size = 0;
+	}
+
+	/* Zero size unregisters the buffer */
+	if (!size) {
+		return 0;
+	}
+
+	if (!IS_PAGE_ALIGNED(base) || !IS_PAGE_ALIGNED(size) ||
+	    size > FLASH_SHMEM_MAX_SIZE || !baikal_is_ns_dram(base, size)) {
+		ERROR("%s: invalid shmem 0x%lx, size 0x%lx\n", __func__, base, size);
+		return -1;
+	}
+
+	err = mmap_add_dynamic_region_alloc_va(base, &flash_shmem_va, size,
+					       MT_MEMORY | MT_RW | MT_NS |
+					       MT_EXECUTE_NEVER);
+	if (err) {
+		ERROR("%s: unable to map shmem 0x%lx, err %d\n", __func__, base, err);
+		flash_shmem_va = 0;
+		return -1;
+	}
+
+	flash_shmem_size = size;
+	return 0;
+}
+
+static void *baikal_smc_flash_shmem_get(const uint64_t offset,
+					const uint64_t size)
+{
+	if (!flash_shmem_size ||
+	    offset > flash_shmem_size ||
+	    size > flash_shmem_size - offset) {
+		ERROR("%s: invalid shmem range 0x%lx, size 0x%lx\n", __func__, offset, size);
+		return NULL;
+	}
+
+	return (void *)(flash_shmem_va + offset);
+}
+
+static int baikal_smc_flash_op_start(const unsigned int op,
+				     const uint64_t addr,
+				     const uint64_t size,
+				     const uint64_t offset)
+{
+	flash_op.data = NULL;
+
+	switch (op) {
+	case BAIKAL_FLASH_OP_ERASE:
+		if (size % BAIKAL_BOOT_SPI_SUBSECTOR) {
+			ERROR("%s: wrong erase size 0x%lx\n", __func__, size);
+			return -1;
+		}
+
+		break;
+	case BAIKAL_FLASH_OP_WRITE:
+		flash_op.data = baikal_smc_flash_shmem_get(offset, size);
+		if (flash_op.data == NULL) {
+			return -1;
+		}
+
+		break;
+	default:
+		ERROR("%s: unknown op %u\n", __func__, op);
+		return -1;
+	}
+
+	if (addr > BAIKAL_BOOT_SPI_SIZE || size > BAIKAL_BOOT_SPI_SIZE - addr) {
+		ERROR("%s: invalid range 0x%lx, size 0x%lx\n", __func__, addr, size);
+		return -1;
+	}
+
+	flash_op.op = op;
+	flash_op.addr = addr;
+	flash_op.size = size;
+	flash_op.done = 0;
+	flash_op.err = 0;
+	flash_op.step_timeout = timeout_init_us(FLASH_OP_STEP_TIMEOUT_US);
+	flash_op.active = true;
+	return 0;
+}
+
+/*
+ * Advance the operation for at most FLASH_OP_BUDGET_US: issue the next
+ * erase or page program whenever the flash becomes ready.
+ */
+static int baikal_smc_flash_op_continue(uint64_t *const data)
+{
+	const uint64_t timeout = timeout_init_us(FLASH_OP_BUDGET_US);
+	int ret;
+
+	while (flash_op.active) {
+		ret = bootflash_busy();
+		if (ret < 0) {
+			flash_op.err = ret;
+			flash_op.active = false;
+			break;
+		} else if (ret && timeout_elapsed(flash_op.step_timeout)) {
+			ERROR("%s: flash is stuck at 0x%lx\n", __func__,
+			      flash_op.addr + flash_op.done);
+			flash_op.err = -ETIMEDOUT;
+			flash_op.active = false;
+			break;
+		} else if (!ret) {
+			const uint32_t addr = flash_op.addr + flash_op.done;
+			const size_t size = flash_op.size - flash_op.done;
+
+			if (!size) {
+				flash_op.active = false;
+				break;
+			}
+
+			if (flash_op.op == BAIKAL_FLASH_OP_ERASE) {
+				ret = bootflash_erase_step(addr, size);
+			} else {
+				ret = bootflash_write_step(addr,
+							   flash_op.data + flash_op.done,
+							   size);
+			}
+
+			if (ret <= 0) {
+				flash_op.err = ret ? ret : -1;
+				flash_op.active = false;
+				break;
+			}
+
+			flash_op.done += ret;
+			flash_op.step_timeout = timeout_init_us(FLASH_OP_STEP_TIMEOUT_US);
+		}
+
+		if (timeout_elapsed(timeout)) {
+			break;
+		}
+	}
+
+	return baikal_smc_flash_op_status(data);
+}
+
+static int baikal_smc_flash_op_status(uint64_t *const data)
+{
+	data[0] = flash_op.done;
+	data[1] = flash_op.size;
+	if (flash_op.err) {
+		return -1;
+	}
+
+	return flash_op.active ? BAIKAL_FLASH_OP_BUSY : BAIKAL_FLASH_OP_DONE;
+}
@@ -7,24 +7,112 @@
 #include <arm_acle.h>
 #include <crc.h>
 
+#ifdef BAIKAL_CRC_BENCH
+#include <arch_helpers.h>
+#include <common/debug.h>
+#endif
+
+/* Minimum size to be split into the interleaved CRC-32 streams */
+#define CRC32_STREAMS		3
+#define CRC32_STREAMS_MIN_SIZE	(CRC32_STREAMS * 1024)
+
+/* CRC-16/XMODEM (polynomial 0x1021) byte table */
+static const uint16_t crc16_table[256] = {
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+	0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+	0x1231, 0x0210, 0x3273, 0x2252, 0x52b5, 0x4294, 0x72f7, 0x62d6,
+	0x9339, 0x8318, 0xb37b, 0xa35a, 0xd3bd, 0xc39c, 0xf3ff, 0xe3de,
+	0x2462, 0x3443, 0x0420, 0x1401, 0x64e6, 0x74c7, 0x44a4, 0x5485,
+	0xa56a, 0xb54b, 0x8528, 0x9509, 0xe5ee, 0xf5cf, 0xc5ac, 0xd58d,
+	0x3653, 0x2672, 0x1611, 0x0630, 0x76d7, 0x66f6, 0x5695, 0x46b4,
+	0xb75b, 0xa77a, 0x9719, 0x8738, 0xf7df, 0xe7fe, 0xd79d, 0xc7bc,
+	0x48c4, 0x58e5, 0x6886, 0x78a7, 0x0840, 0x1861, 0x2802, 0x3823,
+	0xc9cc, 0xd9ed, 0xe98e, 0xf9af, 0x8948, 0x9969, 0xa90a, 0xb92b,
+	0x5af5, 0x4ad4, 0x7ab7, 0x6a96, 0x1a71, 0x0a50, 0x3a33, 0x2a12,
+	0xdbfd, 0xcbdc, 0xfbbf, 0xeb9e, 0x9b79, 0x8b58, 0xbb3b, 0xab1a,
+	0x6ca6, 0x7c87, 0x4ce4, 0x5cc5, 0x2c22, 0x3c03, 0x0c60, 0x1c41,
+	0xedae, 0xfd8f, 0xcdec, 0xddcd, 0xad2a, 0xbd0b, 0x8d68, 0x9d49,
+	0x7e97, 0x6eb6, 0x5ed5, 0x4ef4, 0x3e13, 0x2e32, 0x1e51, 0x0e70,
+	0xff9f, 0xefbe, 0xdfdd, 0xcffc, 0xbf1b, 0xaf3a, 0x9f59, 0x8f78,
+	0x9188, 0x81a9, 0xb1ca, 0xa1eb, 0xd10c, 0xc12d, 0xf14e, 0xe16f,
+	0x1080, 0x00a1, 0x30c2, 0x20e3, 0x5004, 0x4025, 0x7046, 0x6067,
+	0x83b9, 0x9398, 0xa3fb, 0xb3da, 0xc33d, 0xd31c, 0xe37f, 0xf35e,
+	0x02b1, 0x1290, 0x22f3, 0x32d2, 0x4235, 0x5214, 0x6277, 0x7256,
+	0xb5ea, 0xa5cb, 0x95a8, 0x8589, 0xf56e, 0xe54f, 0xd52c, 0xc50d,
+	0x34e2, 0x24c3, 0x14a0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+	0xa7db, 0xb7fa, 0x8799, 0x97b8, 0xe75f, 0xf77e, 0xc71d, 0xd73c,
+	0x26d3, 0x36f2, 0x0691, 0x16b0, 0x6657, 0x7676, 0x4615, 0x5634,
+	0xd94c, 0xc96d, 0xf90e, 0xe92f, 0x99c8, 0x89e9, 0xb98a, 0xa9ab,
+	0x5844, 0x4865, 0x7806, 0x6827, 0x18c0, 0x08e1, 0x3882, 0x28a3,
+	0xcb7d, 0xdb5c, 0xeb3f, 0xfb1e, 0x8bf9, 0x9bd8, 0xabbb, 0xbb9a,
+	0x4a75, 0x5a54, 0x6a37, 0x7a16, 0x0af1, 0x1ad0, 0x2ab3, 0x3a92,
+	0xfd2e, 0xed0f, 0xdd6c, 0xcd4d, 0xbdaa, 0xad8b, 0x9de8, 0x8dc9,
+	0x7c26, 0x6c07, 0x5c64, 0x4c45, 0x3ca2, 0x2c83, 0x1ce0, 0x0cc1,
+	0xef1f, 0xff3e, 0xcf5d, 0xdf7c, 0xaf9b, 0xbfba, 0x8fd9, 0x9ff8,
+	0x6e17, 0x7e36, 0x4e55, 0x5e74, 0x2e93, 0x3eb2, 0x0ed1, 0x1ef0
+};
+
+/* x^(2^n) modulo p(x), reflected CRC-32 polynomial (from lib/zlib/crc32.h) */
+static const uint32_t x2n_table[32] = {
+	0x40000000, 0x20000000, 0x08000000, 0x00800000, 0x00008000,
+	0xedb88320, 0xb1e6b092, 0xa06a2517, 0xed627dae, 0x88d14467,
+	0xd7bbfe6a, 0xec447f11, 0x8e7ea170, 0x6427800e, 0x4d47bae0,
+	0x09fe548f, 0x83852d0f, 0x30362f1a, 0x7b5a9cc3, 0x31fec169,
+	0x9fec022a, 0x6c8dedc4, 0x15d6874d, 0x5fde7a4e, 0xbad90e37,
+	0x2e4e5eef, 0x4eaba214, 0xa8a472c0, 0x429a969e, 0x148d302a,
+	0xc40ba6d0, 0xc4e22c3c
+};
+
 uint16_t crc16(const void *data, size_t size, uint16_t crc)
 {
 	const uint8_t *ptr = data;
 
 	while (size--) {
-		unsigned int i = 0;
+		crc = crc << 8 ^ crc16_table[(crc >> 8 ^ *ptr++) & 0xff];
+	}
 
-		crc ^= *ptr++ << 8;
-		while (i++ < 8) {
-			if (crc & 0x8000) {
-				crc = crc << 1 ^ 0x1021;
-			} else {
-				crc <<= 1;
+	return crc;
+}
+
+/*
+ * Return a(x) multiplied by b(x) modulo p(x), where p(x) is the reflected
+ * CRC-32 polynomial. The a(x) must not be zero.
+ */
+static uint32_t multmodp(uint32_t a, uint32_t b)
+{
+	uint32_t m = 1U << 31;
+	uint32_t p = 0;
+
+	for (;;) {
+		if (a & m) {
+			p ^= b;
+			if ((a & (m - 1)) == 0) {
+				break;
 			}
 		}
+
+		m >>= 1;
+		b = b & 1 ? (b >> 1) ^ 0xedb88320 : b >> 1;
+	}
+
+	return p;
+}
+
+/* Return x^(n * 2^k) modulo p(x) */
+static uint32_t x2nmodp(size_t n, unsigned int k)
+{
+	uint32_t p = 1U << 31; /* x^0 == 1 */
+
+	while (n) {
+		if (n & 1) {
+			p = multmodp(x2n_table[k & 31], p);
+		}
+
+		n >>= 1;
+		k++;
 	}
 
-	return crc;
+	return p;
 }
 
 /*
@@ -34,21 +122,127 @@ uint16_t crc16(const void *data, size_t size, uint16_t crc)
  * The main difference is crc32() allows input buffer to start from
  * address 0 (which is important for checksumming contents of mailbox).
  *
+ * The aligned part of the buffer is processed 8 bytes at a time. Large
+ * buffers are split into three streams which are computed in one loop
+ * to hide the latency of the CRC instructions, and their results are
+ * combined at the end.
+ *
  * Make sure to add a compile switch '-march=armv8-a+crc"
  * for successful compilation of this file.
  */
 uint32_t crc32(const void *data, size_t size, uint32_t crc)
 {
 	uint32_t calc_crc = ~crc;
-	const unsigned char *local_buf = data;
+	uintptr_t local_buf = (uintptr_t)data;
 	size_t local_size = size;
 
-	/* Calculate CRC over byte data */
+	/* Calculate CRC over byte data up to the 8-byte boundary */
+	while (local_size != 0UL && (local_buf % sizeof(uint64_t)) != 0UL) {
+		calc_crc = __crc32b(calc_crc, *(const uint8_t *)local_buf);
+		local_buf++;
+		local_size--;
+	}
+
+	if (local_size >= CRC32_STREAMS_MIN_SIZE) {
+		const size_t len = local_size / (CRC32_STREAMS * sizeof(uint64_t));
+		const uint64_t *const buf0 = (const uint64_t *)local_buf;
+		const uint64_t *const buf1 = buf0 + len;
+		const uint64_t *const buf2 = buf1 + len;
+		uint32_t crc1 = 0;
+		uint32_t crc2 = 0;
+		uint32_t shift;
+		size_t i;
+
+		for (i = 0; i < len; i++) {
+			calc_crc = __crc32d(calc_crc, buf0[i]);
+			crc1	 = __crc32d(crc1, buf1[i]);
+			crc2	 = __crc32d(crc2, buf2[i]);
+		}
+
+		/* Shift CRCs of the leading streams by the length of a stream */
+		shift = x2nmodp(len * sizeof(uint64_t), 3);
+		calc_crc = multmodp(shift, calc_crc) ^ crc1;
+		calc_crc = multmodp(shift, calc_crc) ^ crc2;
+
+		local_buf  += CRC32_STREAMS * len * sizeof(uint64_t);
+		local_size -= CRC32_STREAMS * len * sizeof(uint64_t);
+	}
+
+	/* Calculate CRC over double word data */
+	while (local_size >= sizeof(uint64_t)) {
+		calc_crc = __crc32d(calc_crc, *(const uint64_t *)local_buf);
+		local_buf  += sizeof(uint64_t);
+		local_size -= sizeof(uint64_t);
+	}
+
+	/* Calculate CRC over the remaining byte data */
 	while (local_size != 0UL) {
-		calc_crc = __crc32b(calc_crc, *local_buf);
+		calc_crc = __crc32b(calc_crc, *(const uint8_t *)local_buf);
 		local_buf++;
 		local_size--;
 	}
 
 	return ~calc_crc;
 }
+
+#ifdef BAIKAL_CRC_BENCH
+static uint32_t crc32_bytewise(const void *data, size_t size, uint32_t crc)
+{
+	uint32_t calc_crc = ~crc;
+	const unsigned char *local_buf = data;
+
+	while (size--) {
+		calc_crc = __crc32b(calc_crc, *local_buf++);
+	}
+
+	return ~calc_crc;
+}
+
+static uint16_t crc16_bitwise(const void *data, size_t size, uint16_t crc)
+{
+	const uint8_t *ptr = data;
+
+	while (size--) {
+		unsigned int i = 0;
+
+		crc ^= *ptr++ << 8;
+		while (i++ < 8) {
+			if (crc & 0x8000) {
+				crc = crc << 1 ^ 0x1021;
+			} else {
+				crc <<= 1;
+			}
+		}
+	}
+
+	return crc;
+}
+
+/* Compare the reference and the optimized implementations on a buffer */
+void crc_bench(const void *data, size_t size)
+{
+	uint64_t t0, t1, t2;
+	uint32_t crc32_ref, crc32_opt;
+	uint16_t crc16_ref, crc16_opt;
+
+	t0 = read_cntpct_el0();
+	crc32_ref = crc32_bytewise(data, size, 0);
+	t1 = read_cntpct_el0();
+	crc32_opt = crc32(data, size, 0);
+	t2 = read_cntpct_el0();
+	NOTICE("CRC32: 0x%lx bytes: bytewise 0x%08x in %lu ticks, optimized 0x%08x in %lu ticks\n",
+	       size, crc32_ref, t1 - t0, crc32_opt, t2 - t1);
+
+	t0 = read_cntpct_el0();
+	crc16_ref = crc16_bitwise(data, size, 0);
+	t1 = read_cntpct_el0();
+	crc16_opt = crc16(data, size, 0);
+	t2 = read_cntpct_el0();
+	NOTICE("CRC16: 0x%lx bytes: bitwise 0x%04x in %lu ticks, table 0x%04x in %lu ticks\n",
+	       size, crc16_ref, t1 - t0, crc16_opt, t2 - t1);
+
+	if (crc32_ref != crc32_opt || crc16_ref != crc16_opt) {
+		ERROR("CRC: results mismatch\n");
+	}
+}
+#endif
@@ -5,6 +5,7 @@
  */
 
 #include <assert.h>
+#include <errno.h>
 #include <stdint.h>
 
 #include <drivers/delay_timer.h>
@@ -78,27 +79,31 @@ struct i2c_regs {
 #define MIN_FS_SCL_HIGHTIME		600
 #define MIN_FS_SCL_LOWTIME		1300
 
-int i2c_txrx(const uintptr_t base,
-	     const unsigned int iclk,
-	     const unsigned int targetaddr,
-	     const void *const txbuf,
-	     const unsigned int txbufsize,
-	     void *const rxbuf,
-	     const unsigned int rxbufsize)
+int i2c_xfer_start(struct i2c_xfer *const xfer,
+		   const uintptr_t base,
+		   const unsigned int iclk,
+		   const unsigned int targetaddr,
+		   const void *const txbuf,
+		   const unsigned int txbufsize,
+		   void *const rxbuf,
+		   const unsigned int rxbufsize)
 {
-	uint64_t activity_timeout;
-	int err;
 	volatile struct i2c_regs *const i2cregs = (volatile struct i2c_regs *const)base;
-	unsigned int rxedsize = 0;
-	uint8_t *const rxptr = (uint8_t *)rxbuf;
-	unsigned int txedsize = 0;
-	const uint8_t *const txptr = (uint8_t *)txbuf;
 
+	assert(xfer != NULL);
 	assert(i2cregs != NULL);
 	assert(targetaddr <= 0x7f);
 	assert(txbuf != NULL || !txbufsize);
 	assert(rxbuf != NULL || !rxbufsize);
 
+	xfer->base	= base;
+	xfer->txbuf	= txbuf;
+	xfer->txbufsize	= txbufsize;
+	xfer->txedsize	= 0;
+	xfer->rxbuf	= rxbuf;
+	xfer->rxbufsize	= rxbufsize;
+	xfer->rxedsize	= 0;
+
 	i2cregs->ic_enable	= 0;
 	i2cregs->ic_con		= IC_CON_IC_SLAVE_DISABLE | IC_CON_SPEED | IC_CON_MASTER_MODE;
 	i2cregs->ic_tar		= targetaddr;
@@ -110,21 +115,33 @@ int i2c_txrx(const uintptr_t base,
 	i2cregs->ic_fs_scl_lcnt	= ((uint64_t)iclk * MIN_FS_SCL_LOWTIME  + 1000000000 - 1) / 1000000000;
 	assert(i2cregs->ic_fs_scl_lcnt + 7 > i2cregs->ic_fs_spklen);
 	i2cregs->ic_enable	= IC_ENABLE_ENABLE;
-	activity_timeout	= timeout_init_us(100000);
+	xfer->activity_timeout	= timeout_init_us(100000);
+
+	return 0;
+}
+
+int i2c_xfer_poll(struct i2c_xfer *const xfer)
+{
+	int err;
+	volatile struct i2c_regs *const i2cregs = (volatile struct i2c_regs *const)xfer->base;
+	uint8_t *const rxptr = (uint8_t *)xfer->rxbuf;
+	const uint8_t *const txptr = (const uint8_t *)xfer->txbuf;
+	const unsigned int rxbufsize = xfer->rxbufsize;
+	const unsigned int txbufsize = xfer->txbufsize;
 
 	for (;;) {
 		const unsigned int ic_status = i2cregs->ic_status;
 
-		if (rxedsize < rxbufsize && (ic_status & IC_STATUS_RFNE)) {
-			rxptr[rxedsize++] = i2cregs->ic_data_cmd;
-			activity_timeout = timeout_init_us(100000);
+		if (xfer->rxedsize < rxbufsize && (ic_status & IC_STATUS_RFNE)) {
+			rxptr[xfer->rxedsize++] = i2cregs->ic_data_cmd;
+			xfer->activity_timeout = timeout_init_us(100000);
 			continue;
 		}
 
 		if (i2cregs->ic_raw_intr_stat & IC_RAW_INTR_STAT_TX_ABRT) {
 			err = -1;
 			break;
-		} else if (txedsize < txbufsize + rxbufsize) {
+		} else if (xfer->txedsize < txbufsize + rxbufsize) {
 			if (ic_status & IC_STATUS_TFNF) {
 				/*
 				 * Driver must set STOP bit if IC_EMPTYFIFO_HOLD_MASTER_EN
@@ -132,26 +149,30 @@ int i2c_txrx(const uintptr_t base,
 				 * detected from the registers. So the STOP bit is always set
 				 * when writing/reading the last byte.
 				 */
-				const uint32_t stop = txedsize < txbufsize + rxbufsize - 1 ?
+				const uint32_t stop = xfer->txedsize < txbufsize + rxbufsize - 1 ?
 						      0 : IC_DATA_CMD_STOP;
 
-				if (txedsize < txbufsize) {
-					i2cregs->ic_data_cmd = stop | txptr[txedsize];
+				if (xfer->txedsize < txbufsize) {
+					i2cregs->ic_data_cmd = stop | txptr[xfer->txedsize];
 				} else {
 					i2cregs->ic_data_cmd = stop | IC_DATA_CMD_CMD;
 				}
 
-				activity_timeout = timeout_init_us(100000);
-				++txedsize;
+				xfer->activity_timeout = timeout_init_us(100000);
+				++xfer->txedsize;
 			} else if (!(ic_status & IC_STATUS_MST_ACTIVITY) &&
-					timeout_elapsed(activity_timeout)) {
+					timeout_elapsed(xfer->activity_timeout)) {
 				err = -1;
 				break;
+			} else {
+				return -EAGAIN;
 			}
 		} else if ((ic_status & IC_STATUS_TFE) &&
 			  !(ic_status & IC_STATUS_MST_ACTIVITY)) {
 			err = 0;
 			break;
+		} else {
+			return -EAGAIN;
 		}
 	}
 
@@ -164,5 +185,26 @@ int i2c_txrx(const uintptr_t base,
 		return -1;
 	}
 
-	return rxedsize;
+	return xfer->rxedsize;
+}
+
+int i2c_txrx(const uintptr_t base,
+	     const unsigned int iclk,
+	     const unsigned int targetaddr,
+	     const void *const txbuf,
+	     const unsigned int txbufsize,
+	     void *const rxbuf,
+	     const unsigned int rxbufsize)
+{
+	struct i2c_xfer xfer;
+	int ret;
+
+	i2c_xfer_start(&xfer, base, iclk, targetaddr,
+		       txbuf, txbufsize, rxbuf, rxbufsize);
+
+	do {
+		ret = i2c_xfer_poll(&xfer);
+	} while (ret == -EAGAIN);
+
+	return ret;
 }
@@ -5,8 +5,10 @@
  */
 
 #include <errno.h>
+#include <stdbool.h>
 #include <stdint.h>
 
+#include <arch_helpers.h>
 #include <common/debug.h>
 #include <drivers/delay_timer.h>
 #include <lib/utils_def.h>
@@ -32,16 +34,34 @@
 #define SPI_DMATDLR	*(volatile uint32_t *)(BAIKAL_BOOT_SPI_BASE + 0x50)
 #define SPI_DMARDLR	*(volatile uint32_t *)(BAIKAL_BOOT_SPI_BASE + 0x54)
 #define SPI_DR		*(volatile uint32_t *)(BAIKAL_BOOT_SPI_BASE + 0x60)
+#define SPI_TXFLR	*(volatile uint32_t *)(BAIKAL_BOOT_SPI_BASE + 0x20)
+#define SPI_RXFLR	*(volatile uint32_t *)(BAIKAL_BOOT_SPI_BASE + 0x24)
 #define SPI_RX_DLY	*(volatile uint32_t *)(BAIKAL_BOOT_SPI_BASE + 0xf0)
+#define SPI_SPI_CTRLR0	*(volatile uint32_t *)(BAIKAL_BOOT_SPI_BASE + 0xf4)
 
 /* CTRLR0 */
 #define SPI_DFS_OFFSET		0
+#define SPI_DFS32_OFFSET	16
+#define SPI_DFS32_MASK		(0x1f << SPI_DFS32_OFFSET)
 #define SPI_TMOD_OFFSET		8
 #define SPI_TMOD_MASK		(3 << SPI_TMOD_OFFSET)
 #define SPI_TMOD_TXRX		0
 #define SPI_TMOD_TX		1
 #define SPI_TMOD_RX		2
 #define SPI_TMOD_EEPROM		3
+#define SPI_FRF_OFFSET		21
+#define SPI_FRF_MASK		(3 << SPI_FRF_OFFSET)
+#define SPI_FRF_STD		0
+#define SPI_FRF_DUAL		1
+#define SPI_FRF_QUAD		2
+
+/* SPI_CTRLR0 (enhanced SPI modes) */
+#define SPI_TRANS_TYPE_TT0	0 /* instruction and address in standard mode */
+#define SPI_ADDR_L_OFFSET	2 /* address length in 4-bit units */
+#define SPI_INST_L_OFFSET	8
+#define SPI_INST_L_8BIT		2
+#define SPI_WAIT_CYCLES_OFFSET	11
+#define SPI_WAIT_CYCLES_MAX	31
 
 /* SPIENR */
 #define SPI_SPIENR_SPI_DE	0
@@ -71,10 +91,19 @@
 /* SPI Flash commands */
 #define CMD_FLASH_RDID		0x9f /* (0, 1 .. 20) Read identification */
 #define CMD_FLASH_READ		0x03 /* (3, 1 .. inf) Read Data Bytes */
+#define CMD_FLASH_FAST_READ	0x0b /* (3+1, 1 .. inf) Fast Read */
+#define CMD_FLASH_DOR		0x3b /* (3+1, 1 .. inf) Dual Output Fast Read */
+#define CMD_FLASH_QOR		0x6b /* (3+1, 1 .. inf) Quad Output Fast Read */
+#define CMD_FLASH_READ4B	0x13 /* (4, 1 .. inf) 4-byte Read */
+#define CMD_FLASH_FAST_READ4B	0x0c /* (4+1, 1 .. inf) 4-byte Fast Read */
+#define CMD_FLASH_DOR4B		0x3c /* (4+1, 1 .. inf) 4-byte Dual Output Fast Read */
+#define CMD_FLASH_QOR4B		0x6c /* (4+1, 1 .. inf) 4-byte Quad Output Fast Read */
+#define CMD_FLASH_RDSFDP	0x5a /* (3+1, 1 .. inf) Read SFDP */
 #define CMD_FLASH_WREN		0x06 /* (0, 0) Write Enable */
 #define CMD_FLASH_WRDI		0x04 /* (0, 0) Write Disable */
 #define CMD_FLASH_PP		0x02 /* (3, 256) Page Program */
 #define CMD_FLASH_SSE		0x20 /* (3, 0) SubSector Erase */
+#define CMD_FLASH_SSE32K	0x52 /* (3, 0) 32KB SubSector Erase */
 #define CMD_FLASH_SE		0xd8 /* (3, 0) Sector Erase */
 #define CMD_FLASH_RDSR		0x05 /* (0, 1) Read Status Register */
 #define CMD_FLASH_WRSR		0x01 /* (0, 1 .. inf) Write Status Register */
@@ -112,11 +141,96 @@
 	_b[4] = (((a) >> 8 * 0) & 0xff);	\
 })
 
-#define SPI_CMD_LEN		(1 + SPI_ADR_LEN_4BYTE)
-#define SPI_MAX_READ		UL(0x10000)
+#define SPI_DUMMY_LEN		1 /* 8 dummy cycles of the 1-1-1 fast reads */
+#define SPI_CMD_LEN		(1 + SPI_ADR_LEN_4BYTE + SPI_DUMMY_LEN)
+#define SPI_MAX_READ		UL(0x10000) /* data frames */
+#define SPI_FIFO_DEFAULT_LEN	8 /* used when the depth can't be detected */
 #define SPI_MAX_WRITE		UL(256) /* (3, 256) Page Program */
 
+/* SFDP (JESD216) */
+#define SFDP_SIGNATURE		0x50444653 /* "SFDP" */
+#define SFDP_MAX_PARAM_HEADERS	8
+#define SFDP_BFPT_ID		0xff00 /* Basic Flash Parameter Table */
+#define SFDP_4BAIT_ID		0xff84 /* 4-byte Address Instruction Table */
+#define SFDP_BFPT_MAX_DWORDS	16
+
+/* BFPT DWORD 1 */
+#define BFPT_DW1_FAST_READ_1_1_2	BIT(16)
+#define BFPT_DW1_FAST_READ_1_1_4	BIT(22)
+/* BFPT DWORD 3: 1-1-4 instruction in bits [31:16], DWORD 4: 1-1-2 in bits [15:0] */
+#define BFPT_READ_WAIT(x)		((x) & 0x1f)
+#define BFPT_READ_MODE(x)		(((x) >> 5) & 0x7)
+#define BFPT_READ_OPCODE(x)		(((x) >> 8) & 0xff)
+/* BFPT DWORD 8-9: erase types 1-4 */
+#define BFPT_ERASE_TYPES		4
+#define BFPT_ERASE_SIZE(x)		((x) & 0xff) /* 2^N bytes */
+#define BFPT_ERASE_OPCODE(x)		(((x) >> 8) & 0xff)
+/* BFPT DWORD 15 */
+#define BFPT_DW15_QER(x)		(((x) >> 20) & 0x7)
+#define BFPT_DW15_QER_NONE		0
+
+/* 4BAIT DWORD 1 */
+#define SFDP_4BAIT_READ			BIT(0)
+#define SFDP_4BAIT_FAST_READ		BIT(1)
+#define SFDP_4BAIT_FAST_READ_1_1_2	BIT(2)
+#define SFDP_4BAIT_FAST_READ_1_1_4	BIT(4)
+
+#ifndef BAIKAL_BOOT_SPI_MAX_LANES
+#define BAIKAL_BOOT_SPI_MAX_LANES	1
+#endif
+
+struct sfdp_header {
+	uint32_t signature;
+	uint8_t minor;
+	uint8_t major;
+	uint8_t nph; /* number of parameter headers - 1 */
+	uint8_t reserved;
+};
+
+struct sfdp_param_header {
+	uint8_t id_lsb;
+	uint8_t minor;
+	uint8_t major;
+	uint8_t length; /* in dwords */
+	uint8_t ptp[3]; /* parameter table pointer */
+	uint8_t id_msb;
+};
+
+struct spi_erase_op {
+	uint32_t size;
+	uint8_t opcode;
+	uint32_t timeout_us;
+};
+
+struct spi_read_op {
+	uint8_t opcode;
+	uint8_t addr_len;
+	uint8_t lanes;
+	uint8_t dummy; /* dummy clock cycles */
+};
+
 static unsigned int adr_mode;
+static unsigned int fifo_len;
+static bool dfs32;
+static uint32_t ctrlr0_std;
+static struct spi_read_op read_op = {
+	.opcode = CMD_FLASH_READ,
+	.lanes = 1
+};
+
+/* Erase instructions, the largest first */
+static const struct spi_erase_op erase_ops[] = {
+	{ 64 * 1024, CMD_FLASH_SE, 3 * 1000 * 1000 },
+	{ 32 * 1024, CMD_FLASH_SSE32K, 2 * 1000 * 1000 },
+	{ BAIKAL_BOOT_SPI_SUBSECTOR, CMD_FLASH_SSE, 1000 * 1000 }
+};
+
+#define SPI_ERASE_SSE		(ARRAY_SIZE(erase_ops) - 1)
+/* The sector size is unknown without SFDP, so only the subsector erase */
+#define SPI_ERASE_DEFAULT	BIT(SPI_ERASE_SSE)
+
+/* Bitmap of erase_ops[] supported by the flash */
+static unsigned int erase_mask = SPI_ERASE_DEFAULT;
 
 static int transfer(const unsigned int line,
 		    void *cmd_, uint32_t cmd_len,
@@ -131,9 +245,10 @@ static int transfer(const unsigned int line,
 	uint8_t *txend	= (void *)((intptr_t)tx	 + (intptr_t)tx_len);
 	uint8_t *rxend	= (void *)((intptr_t)rx	 + (intptr_t)rx_len);
 	uint8_t mode;
+	uint32_t n;
 	uint64_t timeout = timeout_init_us(2 * 1000 * 1000);
 
-	if (cmd == NULL || !cmd_len || line > 3) {
+	if (cmd == NULL || !cmd_len || cmd_len > fifo_len || line > 3) {
 		err = -EINVAL;
 		ERROR("SPI: %s error %d (L%u)\n", __func__, err, __LINE__);
 		return err;
@@ -158,15 +273,22 @@ static int transfer(const unsigned int line,
 		SPI_CTRLR0 |= SPI_TMOD_TX << SPI_TMOD_OFFSET;
 		SPI_SPIENR = SPI_SPIENR_SPI_EN; /* enable FIFO */
 		while (cmd < cmdend) {
-			if (SPI_SR & SPI_SR_TFNF) {
-				SPI_DR = *cmd++;
-			}
+			SPI_DR = *cmd++;
+		}
+
+		/* Prefill FIFO to keep it from running empty when started */
+		n = MIN(fifo_len - cmd_len, tx_len);
+		while (n--) {
+			SPI_DR = *tx++;
 		}
 
 		SPI_SER = 1 << line; /* start sending */
 		while (tx < txend) {
-			if (SPI_SR & SPI_SR_TFNF) {
-				SPI_DR = *tx++;
+			n = MIN(fifo_len - SPI_TXFLR, (uint32_t)(txend - tx));
+			if (n) {
+				while (n--) {
+					SPI_DR = *tx++;
+				}
 			} else if (timeout_elapsed(timeout)) {
 				err = -ETIMEDOUT;
 				ERROR("SPI: %s error %d (L%u)\n", __func__, err, __LINE__);
@@ -186,15 +308,16 @@ static int transfer(const unsigned int line,
 		SPI_CTRLR1 = rx_len - 1; /* set read size */
 		SPI_SPIENR = SPI_SPIENR_SPI_EN; /* enable FIFO */
 		while (cmd < cmdend) {
-			if (SPI_SR & SPI_SR_TFNF) {
-				SPI_DR = *cmd++;
-			}
+			SPI_DR = *cmd++;
 		}
 
 		SPI_SER = 1 << line; /* start sending */
 		while (rx < rxend) { /* read incoming data */
-			if (SPI_SR & SPI_SR_RFNE) {
-				*rx++ = SPI_DR;
+			n = MIN(SPI_RXFLR, (uint32_t)(rxend - rx));
+			if (n) {
+				while (n--) {
+					*rx++ = SPI_DR;
+				}
 			} else if (timeout_elapsed(timeout)) {
 				err = -ETIMEDOUT;
 				ERROR("SPI: %s error %d (L%u)\n", __func__, err, __LINE__);
@@ -237,6 +360,115 @@ exit:
 	return err;
 }
 
+/*
+ * Receive data using the enhanced SPI frame formats of the controller:
+ * instruction and address are sent over a single lane, then the data
+ * is clocked in over 2 or 4 lanes after the given number of wait cycles.
+ * Word aligned buffers are received in 32-bit data frames if the
+ * controller supports them.
+ */
+static int transfer_enh(const unsigned int line,
+			const struct spi_read_op *op,
+			uint32_t address,
+			void *rx_, uint32_t rx_len)
+{
+	int err = 0;
+	uint8_t *rx = rx_;
+	uint8_t *rxend = (void *)((intptr_t)rx + (intptr_t)rx_len);
+	const bool words = dfs32 && !(rx_len % 4) && !((uintptr_t)rx % 4);
+	const uint32_t frames = words ? rx_len / 4 : rx_len;
+	uint32_t frf, n;
+	uint64_t timeout = timeout_init_us(2 * 1000 * 1000);
+
+	if (rx == NULL || !rx_len || frames > SPI_MAX_READ || line > 3) {
+		err = -EINVAL;
+		ERROR("SPI: %s error %d (L%u)\n", __func__, err, __LINE__);
+		return err;
+	}
+
+	switch (op->lanes) {
+	case 2:
+		frf = SPI_FRF_DUAL;
+		break;
+	case 4:
+		frf = SPI_FRF_QUAD;
+		break;
+	default:
+		err = -EINVAL;
+		ERROR("SPI: %s error %d (L%u)\n", __func__, err, __LINE__);
+		return err;
+	}
+
+	SPI_SPIENR = SPI_SPIENR_SPI_DE;
+	SPI_SER = 0;
+#ifdef BAIKAL_BOOT_SPI_CS_GPIO_PIN
+	gpio_out_rst(BAIKAL_BOOT_SPI_GPIO_BASE, BAIKAL_BOOT_SPI_CS_GPIO_PIN); /* GPIO = 0 */
+	gpio_dir_set(BAIKAL_BOOT_SPI_GPIO_BASE, BAIKAL_BOOT_SPI_CS_GPIO_PIN);
+#endif
+	SPI_CTRLR0 = (words ? 31 << SPI_DFS32_OFFSET : ctrlr0_std) |
+		     SPI_TMOD_RX << SPI_TMOD_OFFSET |
+		     frf << SPI_FRF_OFFSET;
+	SPI_CTRLR1 = frames - 1; /* set read size */
+	SPI_SPI_CTRLR0 = SPI_TRANS_TYPE_TT0 |
+			 (op->addr_len * 2) << SPI_ADDR_L_OFFSET |
+			 SPI_INST_L_8BIT << SPI_INST_L_OFFSET |
+			 op->dummy << SPI_WAIT_CYCLES_OFFSET;
+	SPI_SPIENR = SPI_SPIENR_SPI_EN; /* enable FIFO */
+	SPI_DR = op->opcode;
+	SPI_DR = address;
+
+	SPI_SER = 1 << line; /* start sending */
+	while (rx < rxend) { /* read incoming data */
+		n = SPI_RXFLR;
+		if (n && words) {
+			/* The first received byte is in the MSB of a frame */
+			n = MIN(n, (uint32_t)(rxend - rx) / 4);
+			while (n--) {
+				*(uint32_t *)rx = __builtin_bswap32(SPI_DR);
+				rx += 4;
+			}
+		} else if (n) {
+			n = MIN(n, (uint32_t)(rxend - rx));
+			while (n--) {
+				*rx++ = SPI_DR;
+			}
+		} else if (timeout_elapsed(timeout)) {
+			err = -ETIMEDOUT;
+			ERROR("SPI: %s error %d (L%u)\n", __func__, err, __LINE__);
+			goto exit;
+		}
+	}
+
+	while (SPI_SR & SPI_SR_BUSY) {
+		if (timeout_elapsed(timeout)) {
+			err = -ETIMEDOUT;
+			ERROR("SPI: %s error %d (L%u)\n", __func__, err, __LINE__);
+			goto exit;
+		}
+	}
+
+exit:
+#ifdef BAIKAL_BOOT_SPI_CS_GPIO_PIN
+	gpio_out_set(BAIKAL_BOOT_SPI_GPIO_BASE, BAIKAL_BOOT_SPI_CS_GPIO_PIN); /* GPIO = 1 */
+	gpio_dir_clr(BAIKAL_BOOT_SPI_GPIO_BASE, BAIKAL_BOOT_SPI_CS_GPIO_PIN);
+#endif
+	SPI_SER = 0;
+	SPI_SPIENR = SPI_SPIENR_SPI_DE;
+	SPI_CTRLR0 = ctrlr0_std; /* back to the standard frame format */
+	SPI_SPI_CTRLR0 = 0;
+	if (SPI_RISR & SPI_RISR_ERR) {
+		err = -1;
+		ERROR("SPI: %s error %d (L%u)\n", __func__, err, __LINE__);
+	}
+
+	if (SPI_SR & (SPI_SR_RFF | SPI_SR_DCOL)) {
+		err = -1;
+		ERROR("SPI: %s error %d (L%u)\n", __func__, err, __LINE__);
+	}
+
+	return err;
+}
+
 static int exec(int line,
 	 uint8_t cmd_op,
 	 uint32_t address,
@@ -265,10 +497,12 @@ static int exec(int line,
 		lenout = lenbuf;
 		break;
 	case CMD_FLASH_READ:
+	case CMD_FLASH_FAST_READ:
 		out = buf;
 		lenout = lenbuf;
 		/* fallthrough */
 	case CMD_FLASH_SSE:
+	case CMD_FLASH_SSE32K:
 	case CMD_FLASH_SE:
 		if (adr_mode == ADR_MODE_4BYTE) {
 			SPI_SET_ADDRESS_4BYTE(address, cmd);
@@ -280,6 +514,32 @@ static int exec(int line,
 			ERROR("SPI: %s: incorrect address mode\n", __func__);
 			return -ECAPMODE;
 		}
+
+		if (cmd_op == CMD_FLASH_FAST_READ) {
+			cmd[lencmd] = 0; /* dummy */
+			lencmd += SPI_DUMMY_LEN;
+		}
+
+		break;
+	case CMD_FLASH_READ4B:
+	case CMD_FLASH_FAST_READ4B:
+		out = buf;
+		lenout = lenbuf;
+		SPI_SET_ADDRESS_4BYTE(address, cmd);
+		lencmd += SPI_ADR_LEN_4BYTE;
+		if (cmd_op == CMD_FLASH_FAST_READ4B) {
+			cmd[lencmd] = 0; /* dummy */
+			lencmd += SPI_DUMMY_LEN;
+		}
+
+		break;
+	case CMD_FLASH_RDSFDP:
+		out = buf;
+		lenout = lenbuf;
+		SPI_SET_ADDRESS_3BYTE(address, cmd);
+		lencmd += SPI_ADR_LEN_3BYTE;
+		cmd[lencmd] = 0; /* dummy */
+		lencmd += SPI_DUMMY_LEN;
 		break;
 	case CMD_FLASH_WREAR:
 	case CMD_FLASH_WRSR:
@@ -339,14 +599,19 @@ static int wren(int line)
 		return err;
 	}
 
-	return !(status & SPI_FLASH_SR_WEL);
+	if (!(status & SPI_FLASH_SR_WEL)) {
+		ERROR("SPI: %s: write enable latch is not set\n", __func__);
+		return -EIO;
+	}
+
+	return 0;
 }
 
-static int wait(int line)
+static int wait(int line, uint32_t timeout_us)
 {
 	int err;
 	uint8_t status;
-	const uint64_t timeout = timeout_init_us(1000 * 1000);
+	const uint64_t timeout = timeout_init_us(timeout_us);
 
 	do {
 		err = exec(line, CMD_FLASH_RDSR, 0, &status, 1);
@@ -363,6 +628,40 @@ static int wait(int line)
 	return 0;
 }
 
+/* Select the largest erase instruction that fits the aligned range */
+static const struct spi_erase_op *erase_op_select(uint32_t adr, size_t size)
+{
+	unsigned int i;
+
+	for (i = 0; i < SPI_ERASE_SSE; ++i) {
+		if ((erase_mask & BIT(i)) &&
+		    !(adr % erase_ops[i].size) &&
+		    size >= erase_ops[i].size) {
+			break;
+		}
+	}
+
+	return &erase_ops[i];
+}
+
+#if LOG_LEVEL >= LOG_LEVEL_VERBOSE
+static void erase_plan_print(uint32_t adr, size_t size)
+{
+	unsigned int cnt[ARRAY_SIZE(erase_ops)] = {0};
+
+	while (size) {
+		const struct spi_erase_op *op = erase_op_select(adr, size);
+
+		++cnt[op - erase_ops];
+		adr  += op->size;
+		size -= op->size;
+	}
+
+	VERBOSE("SPI: erase plan: %u x 64K, %u x 32K, %u x 4K\n",
+		cnt[0], cnt[1], cnt[2]);
+}
+#endif
+
 int spi_flash_erase(int line, uint32_t adr, size_t size)
 {
 	int err;
@@ -374,29 +673,48 @@ int spi_flash_erase(int line, uint32_t adr, size_t size)
 		return -1;
 	}
 
+#if LOG_LEVEL >= LOG_LEVEL_VERBOSE
+	erase_plan_print(adr, size);
+#endif
 	while (size) {
+		const struct spi_erase_op *op = erase_op_select(adr, size);
+
 		err = wren(line);
 		if (err) {
 			return err;
 		}
 
-		err = exec(line, CMD_FLASH_SSE, adr, 0, 0);
+		err = exec(line, op->opcode, adr, 0, 0);
 		if (err) {
 			return err;
 		}
 
-		err = wait(line);
+		err = wait(line, op->timeout_us);
 		if (err) {
 			return err;
 		}
 
-		adr  += BAIKAL_BOOT_SPI_SUBSECTOR;
-		size -= BAIKAL_BOOT_SPI_SUBSECTOR;
+		adr  += op->size;
+		size -= op->size;
 	}
 
 	return 0;
 }
 
+/* Size of the part that fits the page at the given address */
+static int write_part(uint32_t adr, size_t size)
+{
+	int part = MIN(size, SPI_MAX_WRITE);
+	int p1 = adr / SPI_MAX_WRITE; /* page number */
+	int p2 = (adr + part) / SPI_MAX_WRITE;
+
+	if (p1 != p2) { /* page overflow ? */
+		part = p2 * SPI_MAX_WRITE - adr; /* fix part size */
+	}
+
+	return part;
+}
+
 int spi_flash_write(int line, uint32_t adr, void *data, size_t size)
 {
 	int err;
@@ -405,13 +723,7 @@ int spi_flash_write(int line, uint32_t adr, void *data, size_t size)
 	VERBOSE("SPI: %s(0x%x, 0x%lx)\n", __func__, adr, size);
 
 	while (size) {
-		int part = MIN(size, SPI_MAX_WRITE);
-		int p1 = adr / SPI_MAX_WRITE; /* page number */
-		int p2 = (adr + part) / SPI_MAX_WRITE;
-
-		if (p1 != p2) { /* page overflow ? */
-			part = p2 * SPI_MAX_WRITE - adr; /* fix part size */
-		}
+		int part = write_part(adr, size);
 
 		err = wren(line);
 		if (err) {
@@ -423,7 +735,7 @@ int spi_flash_write(int line, uint32_t adr, void *data, size_t size)
 			return err;
 		}
 
-		err = wait(line);
+		err = wait(line, 1000 * 1000);
 		if (err) {
 			return err;
 		}
@@ -436,17 +748,102 @@ int spi_flash_write(int line, uint32_t adr, void *data, size_t size)
 	return 0;
 }
 
+int spi_flash_busy(int line)
+{
+	int err;
+	uint8_t status;
+
+	err = exec(line, CMD_FLASH_RDSR, 0, &status, 1);
+	if (err) {
+		return err;
+	}
+
+	return !!(status & SPI_FLASH_SR_WIP);
+}
+
+/*
+ * Issue a single erase instruction at the start of the range without
+ * waiting for its completion. Returns the number of bytes being erased.
+ */
+int spi_flash_erase_step(int line, uint32_t adr, size_t size)
+{
+	const struct spi_erase_op *op;
+	int err;
+
+	if (!size || size % BAIKAL_BOOT_SPI_SUBSECTOR) {
+		ERROR("SPI: wrong erase size\n");
+		return -1;
+	}
+
+	op = erase_op_select(adr, size);
+	err = wren(line);
+	if (err) {
+		return err;
+	}
+
+	err = exec(line, op->opcode, adr, 0, 0);
+	if (err) {
+		return err;
+	}
+
+	return op->size;
+}
+
+/*
+ * Issue a single page program at the start of the range without waiting
+ * for its completion. Returns the number of bytes being programmed.
+ */
+int spi_flash_write_step(int line, uint32_t adr, void *data, size_t size)
+{
+	const int part = write_part(adr, size);
+	int err;
+
+	if (!size) {
+		return -1;
+	}
+
+	err = wren(line);
+	if (err) {
+		return err;
+	}
+
+	err = exec(line, CMD_FLASH_PP, adr, data, part);
+	if (err) {
+		return err;
+	}
+
+	return part;
+}
+
 int spi_flash_read(int line, uint32_t adr, void *data, size_t size)
 {
 	int err;
 	uint8_t *pdata = data;
+#ifdef BAIKAL_SPI_FLASH_BENCH
+	const size_t total = size;
+	const uint64_t start = read_cntpct_el0();
+	uint64_t ticks;
+#endif
 
 	VERBOSE("SPI: %s(0x%x, 0x%lx)\n", __func__, adr, size);
 
 	while (size) {
-		int part = MIN(size, SPI_MAX_READ);
+		size_t part;
+
+		if (read_op.lanes > 1) {
+			/* Let the aligned part be received in 32-bit frames */
+			if (dfs32 && !((uintptr_t)pdata % 4) && size >= 4) {
+				part = MIN(size & ~3UL, 4 * SPI_MAX_READ);
+			} else {
+				part = MIN(size, SPI_MAX_READ);
+			}
+
+			err = transfer_enh(line, &read_op, adr, pdata, part);
+		} else {
+			part = MIN(size, SPI_MAX_READ);
+			err = exec(line, read_op.opcode, adr, pdata, part);
+		}
 
-		err = exec(line, CMD_FLASH_READ, adr, pdata, part);
 		if (err) {
 			return err;
 		}
@@ -456,9 +853,193 @@ int spi_flash_read(int line, uint32_t adr, void *data, size_t size)
 		size  -= part;
 	}
 
+#ifdef BAIKAL_SPI_FLASH_BENCH
+	ticks = read_cntpct_el0() - start;
+	NOTICE("SPI: read 0x%lx bytes in %lu ticks (%lu KiB/s)\n", total,
+	       ticks, ticks ? total * read_cntfrq_el0() / ticks / 1024 : 0);
+#endif
 	return 0;
 }
 
+/* Detect FIFO depth and support of 32-bit data frames */
+static void spi_fifo_detect(void)
+{
+	unsigned int fifo;
+
+	for (fifo = 1; fifo < 256; ++fifo) {
+		SPI_TXFTLR = fifo;
+		if (SPI_TXFTLR != fifo) {
+			break;
+		}
+	}
+
+	SPI_TXFTLR = 0;
+	if (fifo <= SPI_CMD_LEN) {
+		/* TXFTLR is not writable: no command would fit the detected depth */
+		WARN("SPI: FIFO depth %u is implausible, assuming %u\n",
+		     fifo, SPI_FIFO_DEFAULT_LEN);
+		fifo = SPI_FIFO_DEFAULT_LEN;
+	}
+
+	fifo_len = fifo;
+
+	SPI_CTRLR0 = 31 << SPI_DFS32_OFFSET;
+	dfs32 = (SPI_CTRLR0 & SPI_DFS32_MASK) == (31 << SPI_DFS32_OFFSET);
+	ctrlr0_std = 7 << SPI_DFS_OFFSET;
+	if (dfs32) {
+		ctrlr0_std |= 7 << SPI_DFS32_OFFSET;
+	}
+
+	VERBOSE("SPI: FIFO depth %u, 32-bit frames %ssupported\n",
+		fifo_len, dfs32 ? "" : "not ");
+}
+
+static int sfdp_read(int line, uint32_t adr, void *buf, size_t size)
+{
+	return exec(line, CMD_FLASH_RDSFDP, adr, buf, size);
+}
+
+/* Check whether the controller implements the dual/quad frame formats */
+static int spi_enh_supported(void)
+{
+	uint32_t ctrlr0;
+
+	SPI_SPIENR = SPI_SPIENR_SPI_DE;
+	ctrlr0 = SPI_CTRLR0;
+	SPI_CTRLR0 = ctrlr0 | SPI_FRF_QUAD << SPI_FRF_OFFSET;
+	if (((SPI_CTRLR0 & SPI_FRF_MASK) >> SPI_FRF_OFFSET) != SPI_FRF_QUAD) {
+		SPI_CTRLR0 = ctrlr0;
+		return 0;
+	}
+
+	SPI_CTRLR0 = ctrlr0;
+	return 1;
+}
+
+/*
+ * Select the fastest read instruction supported by both the flash
+ * (according to its SFDP tables) and the controller, and the erase
+ * instructions supported by the flash. The legacy Read Data Bytes
+ * instruction and the 4K subsector erase alone are used when SFDP is
+ * unavailable.
+ */
+static void spi_flash_probe_sfdp(int line)
+{
+	struct sfdp_header hdr;
+	struct sfdp_param_header phdr[SFDP_MAX_PARAM_HEADERS];
+	uint32_t bfpt[SFDP_BFPT_MAX_DWORDS] = {0};
+	uint32_t bfpt_len = 0;
+	uint32_t bait = 0;
+	uint32_t dw = 0;
+	unsigned int i, nph;
+	unsigned int lanes = 1;
+	int err;
+
+	read_op.opcode = CMD_FLASH_READ;
+	read_op.addr_len = adr_mode;
+	read_op.lanes = 1;
+	read_op.dummy = 0;
+	erase_mask = SPI_ERASE_DEFAULT;
+
+	err = sfdp_read(line, 0, &hdr, sizeof(hdr));
+	if (err || hdr.signature != SFDP_SIGNATURE) {
+		INFO("SPI: no SFDP, using Read Data Bytes\n");
+		return;
+	}
+
+	nph = MIN(hdr.nph + 1, SFDP_MAX_PARAM_HEADERS);
+	err = sfdp_read(line, sizeof(hdr), phdr, nph * sizeof(phdr[0]));
+	if (err) {
+		return;
+	}
+
+	for (i = 0; i < nph; ++i) {
+		const unsigned int id = phdr[i].id_msb << 8 | phdr[i].id_lsb;
+		const uint32_t ptp = phdr[i].ptp[2] << 16 |
+				     phdr[i].ptp[1] << 8 |
+				     phdr[i].ptp[0];
+
+		if (id == SFDP_BFPT_ID && !bfpt_len) {
+			bfpt_len = MIN(phdr[i].length, (uint8_t)SFDP_BFPT_MAX_DWORDS);
+			err = sfdp_read(line, ptp, bfpt, bfpt_len * sizeof(bfpt[0]));
+			if (err) {
+				return;
+			}
+		} else if (id == SFDP_4BAIT_ID && phdr[i].length) {
+			err = sfdp_read(line, ptp, &bait, sizeof(bait));
+			if (err) {
+				bait = 0;
+			}
+		}
+	}
+
+	if (bfpt_len < 9) {
+		INFO("SPI: no SFDP BFPT, using Read Data Bytes\n");
+		return;
+	}
+
+	/* Erase types supported by the flash, the subsector erase is kept */
+	erase_mask = BIT(SPI_ERASE_SSE);
+	for (i = 0; i < BFPT_ERASE_TYPES; ++i) {
+		const uint32_t type = bfpt[7 + i / 2] >> (16 * (i % 2));
+		unsigned int j;
+
+		/* Ignore the unused and the nonsensical sizes */
+		if (!BFPT_ERASE_SIZE(type) || BFPT_ERASE_SIZE(type) >= 32) {
+			continue;
+		}
+
+		for (j = 0; j < ARRAY_SIZE(erase_ops); ++j) {
+			if (erase_ops[j].size == (1U << BFPT_ERASE_SIZE(type)) &&
+			    erase_ops[j].opcode == BFPT_ERASE_OPCODE(type)) {
+				erase_mask |= BIT(j);
+			}
+		}
+	}
+
+	/* Fast Read is mandatory for the SFDP compliant devices */
+	read_op.opcode = CMD_FLASH_FAST_READ;
+	read_op.dummy = 8;
+
+	if (BAIKAL_BOOT_SPI_MAX_LANES > 1 && spi_enh_supported()) {
+		/*
+		 * Quad output requires the Quad Enable bit to be set if the
+		 * device has one, so only use it for devices without QE bit.
+		 */
+		if (BAIKAL_BOOT_SPI_MAX_LANES >= 4 &&
+		    (bfpt[0] & BFPT_DW1_FAST_READ_1_1_4) &&
+		    bfpt_len >= 15 &&
+		    BFPT_DW15_QER(bfpt[14]) == BFPT_DW15_QER_NONE) {
+			dw = bfpt[2] >> 16;
+			lanes = 4;
+		} else if (bfpt[0] & BFPT_DW1_FAST_READ_1_1_2) {
+			dw = bfpt[3];
+			lanes = 2;
+		}
+
+		if (lanes > 1 && BFPT_READ_OPCODE(dw) &&
+		    BFPT_READ_WAIT(dw) + BFPT_READ_MODE(dw) <= SPI_WAIT_CYCLES_MAX) {
+			read_op.opcode = BFPT_READ_OPCODE(dw);
+			read_op.lanes = lanes;
+			read_op.dummy = BFPT_READ_WAIT(dw) + BFPT_READ_MODE(dw);
+		}
+	}
+
+	/* Prefer the stateless 4-byte address instructions */
+	if (adr_mode == ADR_MODE_4BYTE) {
+		if (read_op.lanes == 4 && (bait & SFDP_4BAIT_FAST_READ_1_1_4)) {
+			read_op.opcode = CMD_FLASH_QOR4B;
+		} else if (read_op.lanes == 2 && (bait & SFDP_4BAIT_FAST_READ_1_1_2)) {
+			read_op.opcode = CMD_FLASH_DOR4B;
+		} else if (read_op.lanes == 1 && (bait & SFDP_4BAIT_FAST_READ)) {
+			read_op.opcode = CMD_FLASH_FAST_READ4B;
+		}
+	}
+
+	INFO("SPI: read opcode 0x%02x, 1-1-%u, %u dummy cycles\n",
+	     read_op.opcode, read_op.lanes, read_op.dummy);
+}
+
 static int spi_flash_detect(int line)
 {
 	int err;
@@ -531,7 +1112,8 @@ int spi_flash_init(int line)
 #endif
 
 	SPI_SPIENR  = SPI_SPIENR_SPI_DE;
-	SPI_CTRLR0  = 7 << SPI_DFS_OFFSET;
+	spi_fifo_detect();
+	SPI_CTRLR0  = ctrlr0_std;
 	SPI_CTRLR1  = 0;
 	SPI_BAUDR   = BAIKAL_BOOT_SPI_BAUDR;
 	SPI_IMR     = 0;
@@ -556,5 +1138,6 @@ int spi_flash_init(int line)
 		spi_flash_3byte(line);
 	}
 
+	spi_flash_probe_sfdp(line);
 	return 0;
 }
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2023, Baikal Electronics, JSC. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef BAIKAL_BOOT_TIMELINE_H
+#define BAIKAL_BOOT_TIMELINE_H
+
+/*
+ * Cold boot timeline. Each point holds the CNTPCT_EL0 value at the moment
+ * it was passed (0 if it was not). BL1 keeps the points in SRAM until DRAM
+ * is up, then all stages share the BAIKAL_BOOT_TIMELINE_BASE buffer.
+ *
+ * With ENABLE_PMF, BL31 exposes the timeline as a PMF service: the OS gets
+ * a point by PMF_SMC_GET_TIMESTAMP_64 with
+ * tid = (PMF_ARM_TIF_IMPL_ID << 24) | (BAIKAL_PMF_BOOT_SVC_ID << 10) | point
+ * and any valid MPIDR.
+ */
+#define BAIKAL_PMF_BOOT_SVC_ID		0x20
+
+#define BAIKAL_TS_DDR_PORTS		8
+
+enum baikal_boot_ts_id {
+	BAIKAL_TS_BL1_START = 0,
+	BAIKAL_TS_SPD_READ_START,
+	BAIKAL_TS_SPD_READ_END,
+	BAIKAL_TS_DDR_INIT_START,
+	BAIKAL_TS_DDR_FW_READ_START,
+	BAIKAL_TS_DDR_FW_READ_END,
+	/* a port has started training */
+	BAIKAL_TS_DDR_PORT_START,
+	/* a port has completed training */
+	BAIKAL_TS_DDR_PORT_TRAINED = BAIKAL_TS_DDR_PORT_START + BAIKAL_TS_DDR_PORTS,
+	/* a port is usable (ECC memory initialized) */
+	BAIKAL_TS_DDR_PORT_READY = BAIKAL_TS_DDR_PORT_TRAINED + BAIKAL_TS_DDR_PORTS,
+	BAIKAL_TS_DDR_INIT_END = BAIKAL_TS_DDR_PORT_READY + BAIKAL_TS_DDR_PORTS,
+	BAIKAL_TS_MEMTEST_END,
+	/* DTB read and CRC, FIP header check */
+	BAIKAL_TS_BOOT_DEV_PROBE_START,
+	BAIKAL_TS_BOOT_DEV_PROBE_END,
+	BAIKAL_TS_BL1_SPLASH_START,
+	BAIKAL_TS_BL1_SPLASH_END,
+	/* BL2 read from the FIP (and authenticated) */
+	BAIKAL_TS_BL2_LOADED,
+	BAIKAL_TS_BL2_START,
+	BAIKAL_TS_BL31_LOADED,
+	BAIKAL_TS_BL32_LOADED,
+	BAIKAL_TS_BL33_LOADED,
+	BAIKAL_TS_BL31_START,
+	BAIKAL_TS_PCIE_INIT_START,
+	BAIKAL_TS_PCIE_INIT_END,
+	BAIKAL_TS_BL31_SPLASH_START,
+	BAIKAL_TS_BL31_SPLASH_END,
+	BAIKAL_TS_BL31_PLATFORM_SETUP_END,
+	BAIKAL_TS_DRAM_ZERO_START,
+	BAIKAL_TS_DRAM_ZERO_END,
+	BAIKAL_TS_NUM
+};
+
+#ifdef BAIKAL_BOOT_TIMELINE
+void baikal_boot_ts(const unsigned int id);
+#ifdef IMAGE_BL1
+void baikal_boot_ts_handover(void);
+#endif
+#ifdef IMAGE_BL2
+void baikal_boot_ts_image_loaded(const unsigned int image_id);
+#endif
+#ifdef IMAGE_BL31
+void baikal_boot_ts_print(void);
+#endif
+#else
+static inline void baikal_boot_ts(const unsigned int id)
+{
+}
+static inline void baikal_boot_ts_handover(void)
+{
+}
+static inline void baikal_boot_ts_image_loaded(const unsigned int image_id)
+{
+}
+static inline void baikal_boot_ts_print(void)
+{
+}
+#endif
+
+#endif /* BAIKAL_BOOT_TIMELINE_H */
@@ -14,5 +14,8 @@ int bootflash_init(void);
 int bootflash_erase(uint32_t addr, size_t size);
 int bootflash_read(uint32_t addr, void *buf, size_t size);
 int bootflash_write(uint32_t addr, void *data, size_t size);
+int bootflash_busy(void);
+int bootflash_erase_step(uint32_t addr, size_t size);
+int bootflash_write_step(uint32_t addr, void *data, size_t size);
 
 #endif /* BAIKAL_BOOTFLASH_H */
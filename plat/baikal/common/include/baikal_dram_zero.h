@@ -0,0 +1,20 @@
+/*
+ * Copyright (c) 2023, Baikal Electronics, JSC. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef BAIKAL_DRAM_ZERO_H
+#define BAIKAL_DRAM_ZERO_H
+
+#include <stdint.h>
+
+/*
+ * Zero the non-secure DRAM regions ({base, size} pairs of the memory node)
+ * before BL33 is started. Secure DRAM, the non-secure DTB and the BL33
+ * image areas are left intact.
+ */
+int baikal_dram_zero(const uint64_t region_descs[][2],
+		     const unsigned int region_num);
+
+#endif /* BAIKAL_DRAM_ZERO_H */
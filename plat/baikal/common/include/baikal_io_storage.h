@@ -8,5 +8,6 @@
 #define BAIKAL_IO_STORAGE_H
 
 void plat_baikal_io_setup(void);
+void plat_baikal_io_exit(void);
 
 #endif /* BAIKAL_IO_STORAGE_H */
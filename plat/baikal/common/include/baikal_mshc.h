@@ -10,7 +10,9 @@
 #include <drivers/mmc.h>
 
 #define SDHCI_INIT_CLOCK			(300 * 1000)
+#define SDHCI_LEGACY_CLOCK			(25 * 1000 * 1000)
 #define SDHCI_DEFAULT_CLOCK			(50 * 1000 * 1000)
+#define SDHCI_EMMC_HS_CLOCK			(52 * 1000 * 1000)
 #define SDHCI_DEFAULT_BLOCK_SIZE		512
 
 /* Registers */
@@ -176,6 +178,7 @@
 #define  SDHCI_CTRL_DRV_TYPE_D			0x0030
 #define  SDHCI_CTRL_EXEC_TUNING			0x0040
 #define  SDHCI_CTRL_TUNED_CLK			0x0080
+#define  SDHCI_CTRL_ADMA2_LEN_MODE		0x0400
 #define  SDHCI_CMD23_ENABLE			0x0800
 #define  SDHCI_CTRL_V4_MODE			0x1000
 #define  SDHCI_CTRL_64BIT_ADDR			0x2000
@@ -283,6 +286,24 @@
 #define  SDHCI_EMMC_CRC_DISABLE			(1 << 1)
 #define  SDHCI_EMMC_DONT_RESET			(1 << 2)
 
+/* ADMA2 descriptor (v4 mode, 64-bit addressing) */
+#define SDHCI_ADMA2_VALID			(1 << 0)
+#define SDHCI_ADMA2_END				(1 << 1)
+#define SDHCI_ADMA2_INT				(1 << 2)
+#define SDHCI_ADMA2_ACT_TRAN			(2 << 4)
+#define SDHCI_ADMA2_LEN_HI_SHIFT		6
+#define SDHCI_ADMA2_MAX_LEN			(64 * 1024 * 1024 - SDHCI_DEFAULT_BLOCK_SIZE)
+#define SDHCI_ADMA2_BOUNDARY			(128 * 1024 * 1024)
+#define SDHCI_ADMA2_DESC_NUM			8
+
+typedef struct {
+	uint16_t attr;		/* attributes, data length [25:16] in bits 15:6 */
+	uint16_t len;		/* data length [15:0] */
+	uint32_t addr_lo;
+	uint32_t addr_hi;
+	uint32_t reserved;
+} sdhci_adma2_desc_t;
+
 typedef struct {
 	uint32_t size			:11 - 0 + 1;	/* 11 - 0 */
 	uint32_t boundary		:14 - 12 + 1;	/* 14 - 12 */
@@ -492,7 +513,8 @@ enum SpeedMode {
 	SD_25,
 	SD_50,
 	SD_104,
-	DD_50
+	DD_50,
+	DD_52	/* eMMC DDR52 with 3.3V signaling */
 };
 
 enum CmdType {
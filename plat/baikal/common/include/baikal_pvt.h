@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2021-2022, Baikal Electronics, JSC. All rights reserved.
+ * Copyright (c) 2021-2023, Baikal Electronics, JSC. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -11,8 +11,25 @@
 
 #define PVT_READ	0
 #define PVT_WRITE	1
+#define PVT_SHMEM_SET	2
+#define PVT_SNAPSHOT	3
+
+/*
+ * PVT_SNAPSHOT reads the registers selected by a mask (bit n for the offset
+ * 4 * n) of every PVT block into the buffer registered by PVT_SHMEM_SET.
+ * A record per block holds its base, the CNTPCT_EL0 value of the moment it
+ * was read and then the register values in the order of their offsets,
+ * padded to 8 bytes. The size of the records written is returned.
+ */
+struct pvt_snapshot {
+	uint64_t	base;
+	uint64_t	timestamp;
+	uint32_t	regs[];
+};
 
 uint32_t pvt_read_reg(const uintptr_t base, const unsigned int offset);
 uint32_t pvt_write_reg(const uintptr_t base, const unsigned int offset, const uint32_t val);
+int64_t pvt_shmem_set(const uint64_t base, const uint64_t size);
+int64_t pvt_snapshot(const uint32_t mask);
 
 #endif /* BAIKAL_PVT_H */
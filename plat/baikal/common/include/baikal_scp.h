@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2020-2021, Baikal Electronics, JSC. All rights reserved.
+ * Copyright (c) 2020-2023, Baikal Electronics, JSC. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -7,9 +7,32 @@
 #ifndef BAIKAL_SCP_H
 #define BAIKAL_SCP_H
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 int scp_cmd(uint8_t op, uint32_t arg0, uint32_t arg1);
+/*
+ * Commands from several cores are served one by one in the order of their
+ * arrival. The SCP buffer is shared by them, so the size bytes of the
+ * command data are copied from in to the buffer before the command and
+ * the result from the buffer to out after it (either may be NULL).
+ */
+int scp_cmd_xfer(uint8_t op, uint32_t arg0, uint32_t arg1,
+		 const void *in, void *out, size_t size);
+/*
+ * Check that a read command of the given size returns the same data as the
+ * commands of 'chunk' bytes over the same range. Failures are not logged:
+ * they are expected from the firmware not supporting the size.
+ */
+bool scp_cmd_size_check(uint8_t op, uint32_t arg0, size_t size, size_t chunk);
 void *scp_buf(void);
+/*
+ * Send a command without waiting for it, then poll: -EAGAIN is returned
+ * while the SCP is busy with the command, its result after that.
+ */
+int scp_cmd_start(uint8_t op, uint32_t arg0, uint32_t arg1,
+		  const void *in, size_t size);
+int scp_cmd_poll(void);
 
 #endif /* BAIKAL_SCP_H */
@@ -7,8 +7,11 @@
 #ifndef BAIKAL_SIP_SVC_H
 #define BAIKAL_SIP_SVC_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
+#include <lib/spinlock.h>
+
 /* TODO: TF-A uses [0xc2000000:0xc200001f] range for PMF calls */
 #define BAIKAL_SMC_CMU_CMD		0xc2000000
 #define BAIKAL_SMC_PVT_CMD		0xc2000001
@@ -20,6 +23,12 @@
 #define BAIKAL_SMC_FLASH_POSITION	0xc2000007
 #define BAIKAL_SMC_FLASH_INIT		0xc2000008
 #define BAIKAL_SMC_FLASH_LOCK		0xc2000009
+#define BAIKAL_SMC_FLASH_SHMEM_SET	0xc200000a
+#define BAIKAL_SMC_FLASH_SHMEM_WRITE	0xc200000b
+#define BAIKAL_SMC_FLASH_SHMEM_READ	0xc200000c
+#define BAIKAL_SMC_FLASH_OP_START	0xc200000d
+#define BAIKAL_SMC_FLASH_OP_CONTINUE	0xc200000e
+#define BAIKAL_SMC_FLASH_OP_STATUS	0xc200000f
 #define BAIKAL_SMC_VDU_UPDATE		0xc2000100
 #define BAIKAL_SMC_SCP_LOG_DISABLE	0xc2000200
 #define BAIKAL_SMC_SCP_LOG_ENABLE	0xc2000201
@@ -38,6 +47,27 @@
 #define BAIKAL_SMC_GMAC_DIV2_DISABLE	0xc2000501
 #define BAIKAL_SMC_LSP_MUX		0xc2000600
 
+/* BAIKAL_SMC_FLASH_OP_START operations */
+#define BAIKAL_FLASH_OP_ERASE		0
+#define BAIKAL_FLASH_OP_WRITE		1
+
+/* BAIKAL_SMC_FLASH_OP_CONTINUE/STATUS results */
+#define BAIKAL_FLASH_OP_DONE		0
+#define BAIKAL_FLASH_OP_BUSY		1
+
+/*
+ * Buffers passed by the non-secure world must lie in the non-secure DRAM:
+ * on some platforms the TZC is transparent, so mapping the buffer as
+ * non-secure would not keep the caller away from the secure memory.
+ */
+bool baikal_is_ns_dram(const uint64_t base, const uint64_t size);
+
+/*
+ * The BL31 xlat tables context is not thread-safe: every runtime user of
+ * the dynamic mappings, and of the buffers mapped by them, holds this lock.
+ */
+extern spinlock_t baikal_mmap_lock;
+
 int64_t baikal_smc_flash_handler(const uint32_t smc,
 				 const uint64_t x1,
 				 const uint64_t x2,
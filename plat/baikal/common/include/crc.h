@@ -12,5 +12,8 @@
 
 uint16_t crc16(const void *data, size_t size, uint16_t crc);
 uint32_t crc32(const void *data, size_t size, uint32_t crc);
+#ifdef BAIKAL_CRC_BENCH
+void crc_bench(const void *data, size_t size);
+#endif
 
 #endif /* CRC_H */
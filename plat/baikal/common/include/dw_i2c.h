@@ -7,6 +7,34 @@
 #ifndef DW_I2C_H
 #define DW_I2C_H
 
+#include <stdint.h>
+
+/* State of a transfer driven by i2c_xfer_poll() */
+struct i2c_xfer {
+	uintptr_t base;
+	const void *txbuf;
+	unsigned int txbufsize;
+	unsigned int txedsize;
+	void *rxbuf;
+	unsigned int rxbufsize;
+	unsigned int rxedsize;
+	uint64_t activity_timeout;
+};
+
+int i2c_xfer_start(struct i2c_xfer *const xfer,
+		   const uintptr_t base,
+		   const unsigned int iclk,
+		   const unsigned int targetaddr,
+		   const void *const txbuf,
+		   const unsigned int txbufsize,
+		   void *const rxbuf,
+		   const unsigned int rxbufsize);
+/*
+ * Make progress on the transfer without waiting for the bus.
+ * Returns -EAGAIN while the transfer is in progress, then the number
+ * of received bytes or -1 on error.
+ */
+int i2c_xfer_poll(struct i2c_xfer *const xfer);
 int i2c_txrx(const uintptr_t base,
 	     const unsigned int iclk,
 	     const unsigned int targetaddr,
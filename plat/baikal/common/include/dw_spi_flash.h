@@ -14,5 +14,8 @@ int spi_flash_init(int line);
 int spi_flash_read(int line, uint32_t adr, void *data, size_t size);
 int spi_flash_erase(int line, uint32_t adr, size_t size);
 int spi_flash_write(int line, uint32_t adr, void *data, size_t size);
+int spi_flash_busy(int line);
+int spi_flash_erase_step(int line, uint32_t adr, size_t size);
+int spi_flash_write_step(int line, uint32_t adr, void *data, size_t size);
 
 #endif /* DW_SPI_FLASH_H */
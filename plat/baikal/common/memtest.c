@@ -6,10 +6,136 @@
 
 #include <assert.h>
 #include <stdint.h>
+#include <string.h>
+
+#include <arch_helpers.h>
+#include <common/debug.h>
 
 #include <memtest.h>
 #include <xorshift.h>
 
+#define MEMTEST_LANES		4
+#define MEMTEST_BLOCK_SIZE	(MEMTEST_LANES * sizeof(uint64_t))
+#define MEMTEST_MAX_REPORTS	10
+
+/*
+ * 'set' and 'cleared' accumulate the data bits (DQ lanes) that were read
+ * back as 1 or 0 against the expected pattern.
+ */
+struct memtest_result {
+	uint64_t	set;
+	uint64_t	cleared;
+	unsigned int	err_cnt;
+};
+
+static void memtest_lanes_init(uint64_t *const lanes, const uint64_t seed)
+{
+	unsigned int i;
+
+	/*
+	 * Each lane runs its own xorshift64 sequence, so the generator has
+	 * no serial dependency between neighbouring words. Lane seeds must
+	 * be non-zero: a zero state would stay zero forever.
+	 */
+	for (i = 0; i < MEMTEST_LANES; ++i) {
+		lanes[i] = xorshift64(seed + (i + 1) * 0x9e3779b97f4a7c15ULL);
+		if (lanes[i] == 0) {
+			lanes[i] = 0xa5a5a5a5a5a5a5a5ULL;
+		}
+	}
+}
+
+static void memtest_report(struct memtest_result *const res,
+			   const uint64_t *const ptr,
+			   const uint64_t expected,
+			   const uint64_t actual)
+{
+	const uint64_t d = actual ^ expected;
+	const uint64_t set = d & actual;
+	const uint64_t cleared = d & expected;
+
+	res->set |= set;
+	res->cleared |= cleared;
+	if (res->err_cnt++ < MEMTEST_MAX_REPORTS) {
+		ERROR("memtest @ %p: expected:0x%016lx actual:0x%016lx\n",
+		      ptr, expected, actual);
+		ERROR("\t(set: %016lx, cleared: %016lx)\n", set, cleared);
+	}
+}
+
+static void memtest_fill_lanes(uint64_t *ptr,
+			       uint64_t *const end,
+			       const uint64_t seed)
+{
+	uint64_t lanes[MEMTEST_LANES];
+	unsigned int i;
+
+	memtest_lanes_init(lanes, seed);
+
+	for (; ptr + MEMTEST_LANES <= end; ptr += MEMTEST_LANES) {
+		const uint64_t v0 = lanes[0] = xorshift64(lanes[0]);
+		const uint64_t v1 = lanes[1] = xorshift64(lanes[1]);
+		const uint64_t v2 = lanes[2] = xorshift64(lanes[2]);
+		const uint64_t v3 = lanes[3] = xorshift64(lanes[3]);
+
+		/*
+		 * Non-temporal stores: the pattern is not read back until the
+		 * whole range is written, so there is no point in allocating
+		 * it in the caches.
+		 */
+		__asm__ volatile("stnp	%1, %2, [%0]\n"
+				 "stnp	%3, %4, [%0, #16]\n"
+				 : : "r" (ptr), "r" (v0), "r" (v1), "r" (v2), "r" (v3)
+				 : "memory");
+	}
+
+	for (i = 0; ptr < end; ++i) {
+		*ptr++ = lanes[i] = xorshift64(lanes[i]);
+	}
+}
+
+static void memtest_check_lanes(const uint64_t *ptr,
+				const uint64_t *const end,
+				const uint64_t seed,
+				struct memtest_result *const res)
+{
+	uint64_t lanes[MEMTEST_LANES];
+	unsigned int i;
+
+	memtest_lanes_init(lanes, seed);
+
+	for (; ptr + MEMTEST_LANES <= end; ptr += MEMTEST_LANES) {
+		const volatile uint64_t *const vptr = ptr;
+		const uint64_t a0 = vptr[0], a1 = vptr[1];
+		const uint64_t a2 = vptr[2], a3 = vptr[3];
+
+		for (i = 0; i < MEMTEST_LANES; ++i) {
+			lanes[i] = xorshift64(lanes[i]);
+		}
+
+		/* Compare the whole block at once, go word by word on a mismatch */
+		if (((a0 ^ lanes[0]) | (a1 ^ lanes[1]) |
+		     (a2 ^ lanes[2]) | (a3 ^ lanes[3])) != 0) {
+			const uint64_t actual[MEMTEST_LANES] = {a0, a1, a2, a3};
+
+			for (i = 0; i < MEMTEST_LANES; ++i) {
+				if (actual[i] != lanes[i]) {
+					memtest_report(res, ptr + i, lanes[i], actual[i]);
+				}
+			}
+		}
+	}
+
+	for (i = 0; ptr < end; ++i, ++ptr) {
+		const uint64_t actual = *(const volatile uint64_t *)ptr;
+
+		lanes[i] = xorshift64(lanes[i]);
+		if (actual != lanes[i]) {
+			memtest_report(res, ptr, lanes[i], actual);
+		}
+	}
+}
+
 int memtest_rand64(const uintptr_t base,
 		   const size_t size,
 		   const unsigned int incr,
@@ -29,6 +155,23 @@ int memtest_rand64(const uintptr_t base,
 
 	INFO("%s: 0x%lx-0x%lx / 0x%x\n", __func__, base, base + size - 1, incr);
 
+	if (incr == sizeof(uint64_t)) {
+		uint64_t *const end = (uint64_t *)(base + size);
+		struct memtest_result res;
+
+		memset(&res, 0, sizeof(res));
+		memtest_fill_lanes((uint64_t *)base, end, seed);
+		dsb();
+		memtest_check_lanes((uint64_t *)base, end, seed, &res);
+		if (res.err_cnt) {
+			ERROR("%s: total %u errors (set bits: %016lx, cleared bits: %016lx)\n",
+			      __func__, res.err_cnt, res.set, res.cleared);
+			return -1;
+		}
+
+		return 0;
+	}
+
 	val = seed;
 	ptr = (uint64_t *)base;
 	do {
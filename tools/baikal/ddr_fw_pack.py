@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2023, Baikal Electronics, JSC. All rights reserved.
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+
+"""
+Pack a BS1000 DDR PHY training fw container (BAIKAL_DDR_FW_COMPRESSED=1).
+
+The raw container holds the 1D IMEM, 1D DMEM, 2D IMEM and 2D DMEM images
+back to back. Every image is compressed as a separate zlib stream with
+a small window, so BL1 can inflate it straight into PHY SRAM.
+"""
+
+import argparse
+import struct
+import sys
+import zlib
+
+MAGIC = 0x5a574644  # "DFWZ"
+WBITS = 12
+CONTAINER_SIZE = 55036
+WORKSPACE = 12 * 1024
+
+# (offset, size) of the images, see ddr_phy_train_struct.h
+IMAGES = {
+    'udimm': ((0, 25792), (25792, 1748), (27540, 24476), (52016, 1452)),
+    'rdimm': ((0, 26640), (26640, 1816), (28456, 25064), (53520, 1516)),
+}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('type', choices=IMAGES.keys())
+    parser.add_argument('input', help='raw training fw container')
+    parser.add_argument('output', help='compressed training fw container')
+    args = parser.parse_args()
+
+    with open(args.input, 'rb') as f:
+        raw = f.read()
+
+    images = IMAGES[args.type]
+    if len(raw) < images[-1][0] + images[-1][1]:
+        sys.exit('%s: too short for %s container' % (args.input, args.type))
+
+    hdr_size = 8 + 8 * len(images)
+    entries = []
+    data = b''
+    for offs, size in images:
+        z = zlib.compressobj(9, zlib.DEFLATED, WBITS)
+        stream = z.compress(raw[offs:offs + size]) + z.flush()
+        entries.append((hdr_size + len(data), len(stream)))
+        data += stream
+
+    size = hdr_size + len(data)
+    if size > CONTAINER_SIZE - WORKSPACE:
+        sys.exit('compressed container is too big: %d bytes' % size)
+
+    hdr = struct.pack('<II', MAGIC, size)
+    for entry in entries:
+        hdr += struct.pack('<II', *entry)
+
+    with open(args.output, 'wb') as f:
+        f.write(hdr + data)
+
+    print('%s: %d -> %d bytes' % (args.output, len(raw), size))
+
+
+if __name__ == '__main__':
+    main()
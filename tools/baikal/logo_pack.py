@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2023, Baikal Electronics, JSC. All rights reserved.
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+
+"""
+Convert a BMP image into a BM1000 splash logo C array.
+
+16-, 24- and 32-bpp single-plane BMP images are accepted. The logo is
+stored as 24-bpp rows, top row first, each of them run-length encoded
+with packets that do not cross the row end. A packet starts with a
+control byte: with bit 7 set, the next pixel is repeated (bits 6..0) + 1
+times, otherwise (bits 6..0) + 1 literal pixels follow. Pixels are
+stored in BMP (blue, green, red) byte order.
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = 0x454c524c  # "LRLE"
+MAX_RUN = 128
+
+
+def bmp_read(data):
+    if data[:2] != b'BM':
+        sys.exit('not a BMP file')
+
+    pixel_offset, = struct.unpack_from('<I', data, 10)
+    width, height, planes, bpp, compression = \
+        struct.unpack_from('<iiHHI', data, 18)
+    if planes != 1 or bpp not in (16, 24, 32):
+        sys.exit('only 16-, 24- and 32-bpp single-plane BMP files are supported')
+
+    masks = None
+    if bpp == 16:
+        if compression == 3:  # BI_BITFIELDS
+            masks = struct.unpack_from('<III', data, 54)
+        else:
+            masks = (0x7c00, 0x03e0, 0x001f)
+
+    top_down = height < 0
+    height = abs(height)
+    stride = (width * bpp // 8 + 3) & ~3
+    rows = []
+    for y in range(height):
+        line = pixel_offset + (y if top_down else height - 1 - y) * stride
+        row = []
+        for x in range(width):
+            if bpp == 16:
+                v, = struct.unpack_from('<H', data, line + x * 2)
+                row.append(bytes(scale(v, m) for m in reversed(masks)))
+            else:
+                p = line + x * bpp // 8
+                row.append(data[p:p + 3])
+        rows.append(row)
+
+    return width, height, rows
+
+
+def scale(v, mask):
+    shift = (mask & -mask).bit_length() - 1
+    top = mask >> shift
+    return ((v & mask) >> shift) * 255 // top
+
+
+def rle_row(row):
+    out = bytearray()
+    literal = []
+
+    def flush():
+        while literal:
+            chunk = literal[:MAX_RUN]
+            del literal[:MAX_RUN]
+            out.append(len(chunk) - 1)
+            out.extend(b''.join(chunk))
+
+    x = 0
+    while x < len(row):
+        n = 1
+        while x + n < len(row) and n < MAX_RUN and row[x + n] == row[x]:
+            n += 1
+        if n > 1:
+            flush()
+            out.append(0x80 | (n - 1))
+            out.extend(row[x])
+        else:
+            literal.append(row[x])
+        x += n
+
+    flush()
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('-n', '--name', default='bl31_logo', help='array name')
+    parser.add_argument('input', help='BMP file')
+    parser.add_argument('output', nargs='?', help='C file (stdout by default)')
+    args = parser.parse_args()
+
+    with open(args.input, 'rb') as f:
+        width, height, rows = bmp_read(f.read())
+
+    data = b''.join(rle_row(row) for row in rows)
+    blob = struct.pack('<IHHI', MAGIC, width, height, len(data)) + data
+
+    lines = ['const unsigned char %s[] = {' % args.name]
+    for i in range(0, len(blob), 12):
+        chunk = blob[i:i + 12]
+        lines.append('  ' + ', '.join('0x%02x' % b for b in chunk) +
+                     (',' if i + 12 < len(blob) else ''))
+    lines.append('};')
+
+    out = open(args.output, 'w') if args.output else sys.stdout
+    out.write('\n'.join(lines) + '\n')
+    if args.output:
+        out.close()
+        print('%s: %dx%d, %d bytes' % (args.output, width, height, len(blob)),
+              file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()